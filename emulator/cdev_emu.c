@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// The shim preloaded to emulate Linux FireWire character devices by the simulated bus. The
+// library and the applications run without any hardware:
+//
+//   $ export HINAWA_CDEV_EMU="nodes=2,latency=100,busy=16,reset=1000,fcp"
+//   $ LD_PRELOAD=libhinawa-cdev-emu.so ./samples/read-quadlet /dev/fw1
+//
+// The 'nodes' option is the number of emulated special files from /dev/fw0. The other options
+// are passed to the simulated bus per special file; see src/sim_bus.c.
+#define _GNU_SOURCE
+#undef _FILE_OFFSET_BITS
+#include "internal.h"
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#define EMU_ENV			"HINAWA_CDEV_EMU"
+#define EMU_PATH_PREFIX		"/dev/fw"
+#define EMU_DEFAULT_NODES	2
+// The major number of firewire character device is assigned dynamically. This is typical one.
+#define EMU_MAJOR		243
+
+#define EXPORT	__attribute__((visibility("default")))
+
+// The mode is passed only in the case, as __OPEN_NEEDS_MODE() in glibc. O_TMPFILE includes the
+// bit of O_DIRECTORY.
+#define open_needs_mode(flags)	(((flags) & O_CREAT) || ((flags) & O_TMPFILE) == O_TMPFILE)
+
+static struct {
+	GMutex mutex;
+	GHashTable *files;
+	guint nodes;
+	gchar *path;
+
+	int (*open)(const char *path, int flags, ...);
+	int (*openat)(int dirfd, const char *path, int flags, ...);
+	int (*close)(int fd);
+	ssize_t (*read)(int fd, void *buf, size_t count);
+	int (*ioctl)(int fd, unsigned long req, ...);
+	int (*stat)(const char *path, struct stat *buf);
+	int (*stat64)(const char *path, struct stat64 *buf);
+} emu;
+
+static gpointer initialize(gpointer data)
+{
+	const char *env = getenv(EMU_ENV);
+	GString *options = g_string_new("sim:");
+	gchar **tokens;
+	int i;
+
+	emu.open = dlsym(RTLD_NEXT, "open");
+	emu.openat = dlsym(RTLD_NEXT, "openat");
+	emu.close = dlsym(RTLD_NEXT, "close");
+	emu.read = dlsym(RTLD_NEXT, "read");
+	emu.ioctl = dlsym(RTLD_NEXT, "ioctl");
+	emu.stat = dlsym(RTLD_NEXT, "stat");
+	emu.stat64 = dlsym(RTLD_NEXT, "stat64");
+
+	emu.files = g_hash_table_new(g_direct_hash, g_direct_equal);
+	emu.nodes = EMU_DEFAULT_NODES;
+
+	tokens = g_strsplit(env != NULL ? env : "", ",", -1);
+	for (i = 0; tokens[i] != NULL; ++i) {
+		if (g_str_has_prefix(tokens[i], "nodes=")) {
+			emu.nodes = strtoul(tokens[i] + strlen("nodes="), NULL, 10);
+		} else if (tokens[i][0] != '\0') {
+			if (options->str[options->len - 1] != ':')
+				g_string_append_c(options, ',');
+			g_string_append(options, tokens[i]);
+		}
+	}
+	g_strfreev(tokens);
+
+	emu.path = g_string_free(options, FALSE);
+
+	return NULL;
+}
+
+static void ensure_initialized(void)
+{
+	static GOnce once = G_ONCE_INIT;
+
+	g_once(&once, initialize, NULL);
+}
+
+// Return the index of emulated node, or -1 for the other path.
+static int parse_path(const char *path)
+{
+	const char *digits;
+	char *end;
+	unsigned long index;
+
+	if (path == NULL || strncmp(path, EMU_PATH_PREFIX, strlen(EMU_PATH_PREFIX)) != 0)
+		return -1;
+
+	digits = path + strlen(EMU_PATH_PREFIX);
+	if (!g_ascii_isdigit(*digits))
+		return -1;
+	index = strtoul(digits, &end, 10);
+	if (*end != '\0' || index >= emu.nodes)
+		return -1;
+
+	return index;
+}
+
+static gpointer lookup_file(int fd)
+{
+	gpointer data;
+
+	g_mutex_lock(&emu.mutex);
+	data = g_hash_table_lookup(emu.files, GINT_TO_POINTER(fd));
+	g_mutex_unlock(&emu.mutex);
+
+	return data;
+}
+
+static int open_node(int flags)
+{
+	gpointer data;
+	int fd;
+
+	fd = hinawa_fw_node_sim_backend.open(emu.path, flags, &data);
+	if (fd < 0)
+		return -1;
+
+	g_mutex_lock(&emu.mutex);
+	g_hash_table_insert(emu.files, GINT_TO_POINTER(fd), data);
+	g_mutex_unlock(&emu.mutex);
+
+	return fd;
+}
+
+EXPORT int open(const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+
+	ensure_initialized();
+
+	if (open_needs_mode(flags)) {
+		va_list ap;
+
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+
+	if (parse_path(path) >= 0)
+		return open_node(flags);
+
+	return emu.open(path, flags, mode);
+}
+
+EXPORT int open64(const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+
+	if (open_needs_mode(flags)) {
+		va_list ap;
+
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+
+	return open(path, flags | O_LARGEFILE, mode);
+}
+
+EXPORT int openat(int dirfd, const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+
+	ensure_initialized();
+
+	if (open_needs_mode(flags)) {
+		va_list ap;
+
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+
+	if (parse_path(path) >= 0)
+		return open_node(flags);
+
+	return emu.openat(dirfd, path, flags, mode);
+}
+
+EXPORT int close(int fd)
+{
+	gpointer data;
+
+	ensure_initialized();
+
+	g_mutex_lock(&emu.mutex);
+	data = g_hash_table_lookup(emu.files, GINT_TO_POINTER(fd));
+	if (data != NULL)
+		g_hash_table_remove(emu.files, GINT_TO_POINTER(fd));
+	g_mutex_unlock(&emu.mutex);
+
+	// The backend closes the file descriptor by this function again.
+	if (data != NULL) {
+		hinawa_fw_node_sim_backend.close(fd, data);
+		return 0;
+	}
+
+	return emu.close(fd);
+}
+
+EXPORT ssize_t read(int fd, void *buf, size_t count)
+{
+	gpointer data;
+
+	ensure_initialized();
+
+	data = lookup_file(fd);
+	if (data != NULL)
+		return hinawa_fw_node_sim_backend.read(fd, buf, count, data);
+
+	return emu.read(fd, buf, count);
+}
+
+EXPORT int ioctl(int fd, unsigned long req, ...)
+{
+	gpointer data;
+	void *args;
+	va_list ap;
+
+	ensure_initialized();
+
+	va_start(ap, req);
+	args = va_arg(ap, void *);
+	va_end(ap);
+
+	data = lookup_file(fd);
+	if (data != NULL)
+		return hinawa_fw_node_sim_backend.ioctl(fd, req, args, data);
+
+	return emu.ioctl(fd, req, args);
+}
+
+// The applications check the special file in advance.
+static void fill_stat(int index, struct stat64 *buf)
+{
+	memset(buf, 0, sizeof(*buf));
+	buf->st_mode = S_IFCHR | 0660;
+	buf->st_rdev = makedev(EMU_MAJOR, index);
+	buf->st_nlink = 1;
+	buf->st_uid = getuid();
+	buf->st_gid = getgid();
+}
+
+EXPORT int stat(const char *path, struct stat *buf)
+{
+	int index;
+
+	ensure_initialized();
+
+	index = parse_path(path);
+	if (index >= 0) {
+		struct stat64 st;
+
+		fill_stat(index, &st);
+		memset(buf, 0, sizeof(*buf));
+		buf->st_mode = st.st_mode;
+		buf->st_rdev = st.st_rdev;
+		buf->st_nlink = st.st_nlink;
+		buf->st_uid = st.st_uid;
+		buf->st_gid = st.st_gid;
+		return 0;
+	}
+
+	return emu.stat(path, buf);
+}
+
+EXPORT int stat64(const char *path, struct stat64 *buf)
+{
+	int index;
+
+	ensure_initialized();
+
+	index = parse_path(path);
+	if (index >= 0) {
+		fill_stat(index, buf);
+		return 0;
+	}
+
+	return emu.stat64(path, buf);
+}
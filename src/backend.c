@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+// The path for the node in the simulated bus. The optional suffix is the latency to deliver
+// events in microseconds; e.g. 'sim:100'.
+#define SIM_PATH_PREFIX		"sim"
+
+static int kernel_open(const char *path, int flags, gpointer *data)
+{
+	*data = NULL;
+	return open(path, flags);
+}
+
+static void kernel_close(int fd, gpointer data)
+{
+	close(fd);
+}
+
+static int kernel_ioctl(int fd, unsigned long req, void *args, gpointer data)
+{
+	return ioctl(fd, req, args);
+}
+
+static ssize_t kernel_read(int fd, void *buf, size_t length, gpointer data)
+{
+	return read(fd, buf, length);
+}
+
+// The backend for Linux FireWire character device.
+const struct hinawa_fw_node_backend hinawa_fw_node_kernel_backend = {
+	.open	= kernel_open,
+	.close	= kernel_close,
+	.ioctl	= kernel_ioctl,
+	.read	= kernel_read,
+};
+
+const struct hinawa_fw_node_backend *hinawa_fw_node_backend_lookup(const char *path)
+{
+	gsize length = strlen(SIM_PATH_PREFIX);
+
+	if (strncmp(path, SIM_PATH_PREFIX, length) == 0 &&
+	    (path[length] == '\0' || path[length] == ':'))
+		return &hinawa_fw_node_sim_backend;
+
+	if (hinawa_fw_node_replay_path(path))
+		return &hinawa_fw_node_replay_backend;
+
+	return &hinawa_fw_node_kernel_backend;
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+// The buffer to read event is taken from the pool and reference-counted, so that the frame in
+// the event is available as GBytes after the event is dispatched without copying it. The header
+// of buffer is put just before the area of data:
+//
+//   +--------------------+ <- the address of allocated memory
+//   |       header       |
+//   +--------------------+ <- the address of buffer
+//   |        data        |
+//   +--------------------+
+//
+// The buffer is cached in the pool when the last reference is released, then reused by the next
+// read. The pool itself is reference-counted by the buffers taken from it, thus any buffer can
+// be kept after the node is released.
+
+struct buffer_header {
+	struct hinawa_buffer_pool *pool;
+	struct buffer_header *next;
+	gint ref_count;
+	gsize length;
+};
+
+// The data of event should be aligned to 8 bytes at least.
+#define HEADER_SIZE	((sizeof(struct buffer_header) + 15) & ~15)
+
+struct hinawa_buffer_pool {
+	gint ref_count;
+	gsize size;
+	guint max_cached;
+
+	GMutex mutex;
+	struct buffer_header *cached;
+	guint cached_count;
+};
+
+static struct buffer_header *get_header(gconstpointer buf)
+{
+	return (struct buffer_header *)((guint8 *)buf - HEADER_SIZE);
+}
+
+static gpointer get_buffer(struct buffer_header *header)
+{
+	return (guint8 *)header + HEADER_SIZE;
+}
+
+struct hinawa_buffer_pool *hinawa_buffer_pool_new(gsize size, guint max_cached)
+{
+	struct hinawa_buffer_pool *pool = g_new0(struct hinawa_buffer_pool, 1);
+
+	pool->ref_count = 1;
+	pool->size = size;
+	pool->max_cached = max_cached;
+	g_mutex_init(&pool->mutex);
+
+	return pool;
+}
+
+static struct hinawa_buffer_pool *buffer_pool_ref(struct hinawa_buffer_pool *pool)
+{
+	g_atomic_int_inc(&pool->ref_count);
+
+	return pool;
+}
+
+void hinawa_buffer_pool_unref(struct hinawa_buffer_pool *pool)
+{
+	if (!g_atomic_int_dec_and_test(&pool->ref_count))
+		return;
+
+	while (pool->cached != NULL) {
+		struct buffer_header *header = pool->cached;
+
+		pool->cached = header->next;
+		g_free(header);
+	}
+
+	g_mutex_clear(&pool->mutex);
+	g_free(pool);
+}
+
+gsize hinawa_buffer_pool_get_size(const struct hinawa_buffer_pool *pool)
+{
+	return pool->size;
+}
+
+// Take a buffer from the pool with one reference. The length of data is zero.
+gpointer hinawa_buffer_pool_acquire(struct hinawa_buffer_pool *pool)
+{
+	struct buffer_header *header;
+
+	g_mutex_lock(&pool->mutex);
+	header = pool->cached;
+	if (header != NULL) {
+		pool->cached = header->next;
+		--pool->cached_count;
+	}
+	g_mutex_unlock(&pool->mutex);
+
+	if (header == NULL)
+		header = g_malloc(HEADER_SIZE + pool->size);
+
+	header->pool = buffer_pool_ref(pool);
+	header->next = NULL;
+	header->ref_count = 1;
+	header->length = 0;
+
+	return get_buffer(header);
+}
+
+gpointer hinawa_buffer_ref(gpointer buf)
+{
+	g_atomic_int_inc(&get_header(buf)->ref_count);
+
+	return buf;
+}
+
+// Return the buffer to the pool when the last reference is released.
+void hinawa_buffer_unref(gpointer buf)
+{
+	struct buffer_header *header = get_header(buf);
+	struct hinawa_buffer_pool *pool;
+
+	if (!g_atomic_int_dec_and_test(&header->ref_count))
+		return;
+
+	pool = header->pool;
+
+	g_mutex_lock(&pool->mutex);
+	if (pool->cached_count < pool->max_cached) {
+		header->next = pool->cached;
+		pool->cached = header;
+		++pool->cached_count;
+		header = NULL;
+	}
+	g_mutex_unlock(&pool->mutex);
+
+	g_free(header);
+	hinawa_buffer_pool_unref(pool);
+}
+
+void hinawa_buffer_set_length(gpointer buf, gsize length)
+{
+	get_header(buf)->length = length;
+}
+
+gsize hinawa_buffer_get_length(gconstpointer buf)
+{
+	return get_header(buf)->length;
+}
+
+// Create GBytes for the range of data in the buffer. The buffer is kept until the GBytes is
+// released.
+GBytes *hinawa_buffer_slice(gconstpointer buf, gconstpointer data, gsize length)
+{
+	g_return_val_if_fail((const guint8 *)data >= (const guint8 *)buf, NULL);
+	g_return_val_if_fail((const guint8 *)data + length <=
+			     (const guint8 *)buf + hinawa_buffer_get_length(buf), NULL);
+
+	return g_bytes_new_with_free_func(data, length, hinawa_buffer_unref,
+					  hinawa_buffer_ref((gpointer)buf));
+}
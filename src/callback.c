@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+// The function set by the user is kept with the data in the reference-counted structure. The
+// caller takes the reference under the lock of instance, then calls the function without the
+// lock, thus the function can operate the instance, including to set the other function. The
+// data is released when the function is unset and no call of it is in progress.
+
+struct hinawa_callback *hinawa_callback_new(GCallback func, gpointer data, GDestroyNotify notify)
+{
+	struct hinawa_callback *cb;
+
+	if (func == NULL) {
+		if (notify != NULL)
+			notify(data);
+		return NULL;
+	}
+
+	cb = g_new(struct hinawa_callback, 1);
+	cb->ref_count = 1;
+	cb->func = func;
+	cb->data = data;
+	cb->notify = notify;
+
+	return cb;
+}
+
+struct hinawa_callback *hinawa_callback_ref(struct hinawa_callback *cb)
+{
+	g_atomic_int_inc(&cb->ref_count);
+
+	return cb;
+}
+
+void hinawa_callback_unref(struct hinawa_callback *cb)
+{
+	if (!g_atomic_int_dec_and_test(&cb->ref_count))
+		return;
+
+	if (cb->notify != NULL)
+		cb->notify(cb->data);
+	g_free(cb);
+}
+
+// Replace the function under the lock, then release the former one without the lock.
+void hinawa_callback_replace(struct hinawa_callback **slot, GMutex *mutex,
+			     struct hinawa_callback *cb)
+{
+	struct hinawa_callback *old;
+
+	g_mutex_lock(mutex);
+	old = *slot;
+	*slot = cb;
+	g_mutex_unlock(mutex);
+
+	if (old != NULL)
+		hinawa_callback_unref(old);
+}
+
+// Take the reference of function under the lock, or NULL when it is not set.
+struct hinawa_callback *hinawa_callback_get(struct hinawa_callback *const *slot, GMutex *mutex)
+{
+	struct hinawa_callback *cb;
+
+	g_mutex_lock(mutex);
+	cb = *slot;
+	if (cb != NULL)
+		hinawa_callback_ref(cb);
+	g_mutex_unlock(mutex);
+
+	return cb;
+}
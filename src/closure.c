@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+// The value of closure passed to Linux FireWire subsystem is a handle which encodes the index of
+// entry in the registry, the kind of instance, and the generation of entry:
+//
+//   bit 63-32: generation
+//   bit 31-24: kind
+//   bit 23-0:  index
+//
+// The event is delivered to the instance by the lookup of table without any check of type
+// instance. The generation is incremented when the entry is released, thus the completion
+// for released instance is rejected even if the entry is reused.
+
+#define CLOSURE_INDEX_MASK	0x00ffffffULL
+#define CLOSURE_KIND_SHIFT	24
+#define CLOSURE_KIND_MASK	0xffULL
+#define CLOSURE_GENERATION_SHIFT	32
+
+#define INITIAL_ENTRY_COUNT	64
+
+struct closure_entry {
+	gpointer instance;
+	guint32 generation;
+	enum hinawa_closure_kind kind;
+	guint next_free;
+};
+
+static struct {
+	GMutex mutex;
+	struct closure_entry *entries;
+	guint count;
+	guint first_free;
+} registry;
+
+static guint64 build_closure(guint index, const struct closure_entry *entry)
+{
+	return ((guint64)entry->generation << CLOSURE_GENERATION_SHIFT) |
+	       ((guint64)entry->kind << CLOSURE_KIND_SHIFT) |
+	       (guint64)index;
+}
+
+static struct closure_entry *parse_closure(guint64 closure)
+{
+	guint index = closure & CLOSURE_INDEX_MASK;
+	enum hinawa_closure_kind kind = (closure >> CLOSURE_KIND_SHIFT) & CLOSURE_KIND_MASK;
+	guint32 generation = closure >> CLOSURE_GENERATION_SHIFT;
+	struct closure_entry *entry;
+
+	if (index >= registry.count)
+		return NULL;
+
+	entry = registry.entries + index;
+	if (entry->instance == NULL || entry->generation != generation || entry->kind != kind)
+		return NULL;
+
+	return entry;
+}
+
+static void expand_registry(void)
+{
+	guint count = registry.count > 0 ? registry.count * 2 : INITIAL_ENTRY_COUNT;
+	guint i;
+
+	g_return_if_fail(count <= CLOSURE_INDEX_MASK + 1);
+
+	registry.entries = g_renew(struct closure_entry, registry.entries, count);
+	for (i = registry.count; i < count; ++i) {
+		struct closure_entry *entry = registry.entries + i;
+
+		entry->instance = NULL;
+		entry->generation = 1;
+		entry->kind = 0;
+		entry->next_free = i + 1;
+	}
+	registry.first_free = registry.count;
+	registry.count = count;
+}
+
+// Internal use only. Return the handle used for closure of the instance.
+guint64 hinawa_closure_register(enum hinawa_closure_kind kind, gpointer instance)
+{
+	struct closure_entry *entry;
+	guint index;
+
+	g_return_val_if_fail(instance != NULL, 0);
+
+	g_mutex_lock(&registry.mutex);
+
+	if (registry.first_free >= registry.count)
+		expand_registry();
+
+	index = registry.first_free;
+	entry = registry.entries + index;
+	registry.first_free = entry->next_free;
+
+	entry->instance = instance;
+	entry->kind = kind;
+
+	g_mutex_unlock(&registry.mutex);
+
+	return build_closure(index, entry);
+}
+
+// Internal use only. Release the entry for the handle. The handle is not available anymore.
+void hinawa_closure_unregister(guint64 closure)
+{
+	struct closure_entry *entry;
+
+	g_mutex_lock(&registry.mutex);
+
+	entry = parse_closure(closure);
+	if (entry != NULL) {
+		entry->instance = NULL;
+		entry->kind = 0;
+
+		// Zero is not used for generation so that zero is not a valid handle.
+		++entry->generation;
+		if (entry->generation == 0)
+			entry->generation = 1;
+
+		entry->next_free = registry.first_free;
+		registry.first_free = entry - registry.entries;
+	}
+
+	g_mutex_unlock(&registry.mutex);
+}
+
+// Internal use only. Increment the generation of entry for the handle and return new handle
+// for the same instance, or zero when the handle is stale. The completion delivered for the
+// previous handle is rejected after the call.
+guint64 hinawa_closure_renew(guint64 closure)
+{
+	struct closure_entry *entry;
+	guint64 renewed = 0;
+
+	g_mutex_lock(&registry.mutex);
+
+	entry = parse_closure(closure);
+	if (entry != NULL) {
+		++entry->generation;
+		if (entry->generation == 0)
+			entry->generation = 1;
+
+		renewed = build_closure(entry - registry.entries, entry);
+	}
+
+	g_mutex_unlock(&registry.mutex);
+
+	return renewed;
+}
+
+// Internal use only. Return the instance with the reference for the handle, or NULL when the
+// handle is stale.
+gpointer hinawa_closure_lookup(guint64 closure, enum hinawa_closure_kind *kind)
+{
+	struct closure_entry *entry;
+	gpointer instance = NULL;
+
+	g_mutex_lock(&registry.mutex);
+
+	entry = parse_closure(closure);
+	if (entry != NULL) {
+		// The instance is unregistered in dispose, thus it is safe to take the reference.
+		instance = g_object_ref(entry->instance);
+		*kind = entry->kind;
+	}
+
+	g_mutex_unlock(&registry.mutex);
+
+	return instance;
+}
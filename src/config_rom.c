@@ -0,0 +1,554 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+
+/**
+ * HinawaConfigRom:
+ * A boxed object to express index of content of configuration ROM.
+ *
+ * A [struct@ConfigRom] expresses the index of entries in root directory and unit directories of
+ * configuration ROM defined in IEEE 1212, as well as textual descriptor leaves associated to the
+ * entries. The index is built once at instantiation, then any lookup is done by the key of entry
+ * without parsing the content again.
+ *
+ * The key of entry is the combination of key type in higher 2 bits and key ID in lower 6 bits.
+ * For example, 0x03 for vendor ID, 0x17 for model ID, 0x12 for specifier ID, and 0x13 for
+ * version.
+ */
+
+#define BUS_INFO_LENGTH_SHIFT		24
+#define BUS_INFO_MINIMUM_LENGTH		4
+#define DIRECTORY_LENGTH_SHIFT		16
+#define ENTRY_KEY_SHIFT			24
+#define ENTRY_VALUE_MASK		0x00ffffff
+
+#define KEY_TEXTUAL_DESCRIPTOR_LEAF	0x81
+#define KEY_UNIT_DIRECTORY		0xd1
+
+#define KEY_COUNT			256
+
+// The minimal ASCII textual descriptor includes two quadlets for its type and specifier.
+#define TEXT_LEAF_HEADER_QUADLETS	2
+
+struct directory {
+	guint32 values[KEY_COUNT];
+	guint32 present[KEY_COUNT / 32];
+	gchar *texts[KEY_COUNT];
+};
+
+struct _HinawaConfigRom {
+	gint ref_count;
+	GBytes *image;
+
+	gboolean has_guid;
+	guint64 guid;
+
+	struct directory root;
+	struct directory *units;
+	guint unit_count;
+};
+
+G_DEFINE_BOXED_TYPE(HinawaConfigRom, hinawa_config_rom, hinawa_config_rom_ref,
+		    hinawa_config_rom_unref)
+
+static guint32 read_quadlet(const guint8 *data, guint index)
+{
+	return GUINT32_FROM_BE(((const guint32 *)data)[index]);
+}
+
+static gboolean directory_has_entry(const struct directory *dir, guint key)
+{
+	return !!(dir->present[key / 32] & (1u << (key % 32)));
+}
+
+static gchar *parse_text_leaf(const guint8 *data, gsize quads, guint64 offset)
+{
+	guint length;
+	gsize size;
+
+	if (offset + 1 + TEXT_LEAF_HEADER_QUADLETS > quads)
+		return NULL;
+
+	length = read_quadlet(data, offset) >> DIRECTORY_LENGTH_SHIFT;
+	if (length < TEXT_LEAF_HEADER_QUADLETS || offset + 1 + length > quads)
+		return NULL;
+
+	// Just for minimal ASCII; descriptor type, specifier ID, width, character set, and language
+	// are all zero.
+	if (read_quadlet(data, offset + 1) != 0 || read_quadlet(data, offset + 2) != 0)
+		return NULL;
+
+	size = (length - TEXT_LEAF_HEADER_QUADLETS) * 4;
+	return g_strndup((const gchar *)(data + (offset + 1 + TEXT_LEAF_HEADER_QUADLETS) * 4), size);
+}
+
+static void parse_directory(const guint8 *data, gsize quads, guint64 offset, struct directory *dir,
+			    GArray *unit_offsets)
+{
+	gboolean has_prev = FALSE;
+	guint prev_key = 0;
+	guint length;
+	guint i;
+
+	if (offset >= quads)
+		return;
+
+	length = read_quadlet(data, offset) >> DIRECTORY_LENGTH_SHIFT;
+	for (i = 1; i <= length && offset + i < quads; ++i) {
+		guint64 pos = offset + i;
+		guint32 entry = read_quadlet(data, pos);
+		guint key = entry >> ENTRY_KEY_SHIFT;
+		guint32 value = entry & ENTRY_VALUE_MASK;
+
+		// The textual descriptor leaf describes the entry just before.
+		if (key == KEY_TEXTUAL_DESCRIPTOR_LEAF) {
+			if (has_prev && dir->texts[prev_key] == NULL)
+				dir->texts[prev_key] = parse_text_leaf(data, quads, pos + value);
+			continue;
+		}
+
+		if (key == KEY_UNIT_DIRECTORY && unit_offsets != NULL) {
+			guint64 unit_offset = pos + value;
+			g_array_append_val(unit_offsets, unit_offset);
+		}
+
+		// The first entry is indexed when the key appears several times.
+		if (!directory_has_entry(dir, key)) {
+			dir->values[key] = value;
+			dir->present[key / 32] |= 1u << (key % 32);
+		}
+
+		prev_key = key;
+		has_prev = TRUE;
+	}
+}
+
+static void clear_directory(struct directory *dir)
+{
+	guint i;
+
+	for (i = 0; i < KEY_COUNT; ++i)
+		g_free(dir->texts[i]);
+}
+
+// Internal use only. FNV-1a hash of the content, to validate cached index against live content.
+guint64 hinawa_config_rom_compute_hash(GBytes *image)
+{
+	const guint8 *data;
+	gsize size;
+	guint64 hash = 0xcbf29ce484222325ULL;
+	gsize i;
+
+	data = g_bytes_get_data(image, &size);
+	for (i = 0; i < size; ++i) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+// Internal use only. Retrieve the global unique ID from the content without building index.
+gboolean hinawa_config_rom_parse_guid(GBytes *image, guint64 *guid)
+{
+	const guint8 *data;
+	gsize size;
+	guint info_length;
+
+	data = g_bytes_get_data(image, &size);
+	if (size < 4)
+		return FALSE;
+
+	info_length = read_quadlet(data, 0) >> BUS_INFO_LENGTH_SHIFT;
+	if (info_length < BUS_INFO_MINIMUM_LENGTH || info_length >= size / 4)
+		return FALSE;
+
+	*guid = ((guint64)read_quadlet(data, 3) << 32) | read_quadlet(data, 4);
+
+	return TRUE;
+}
+
+// The serialized form of directory:
+//
+//   guint16: the number of entries
+//   guint16: the number of texts
+//   guint32 * entries: key in bits 31-24, value in bits 23-0
+//   texts: guint8 key, guint8 padding, guint16 length, then the characters padded to quadlet
+static void serialize_directory(const struct directory *dir, GByteArray *buf)
+{
+	guint16 counts[2] = {0, 0};
+	guint offset = buf->len;
+	guint key;
+
+	g_byte_array_append(buf, (const guint8 *)counts, sizeof(counts));
+
+	for (key = 0; key < KEY_COUNT; ++key) {
+		if (directory_has_entry(dir, key)) {
+			guint32 entry = (key << ENTRY_KEY_SHIFT) | dir->values[key];
+			g_byte_array_append(buf, (const guint8 *)&entry, sizeof(entry));
+			++counts[0];
+		}
+	}
+
+	for (key = 0; key < KEY_COUNT; ++key) {
+		if (dir->texts[key] != NULL) {
+			static const guint8 padding[4] = {0};
+			guint16 length = strlen(dir->texts[key]);
+			guint8 header[4] = {key, 0};
+
+			memcpy(header + 2, &length, sizeof(length));
+			g_byte_array_append(buf, header, sizeof(header));
+			g_byte_array_append(buf, (const guint8 *)dir->texts[key], length);
+			g_byte_array_append(buf, padding, (4 - length % 4) % 4);
+			++counts[1];
+		}
+	}
+
+	memcpy(buf->data + offset, counts, sizeof(counts));
+}
+
+static gboolean deserialize_directory(struct directory *dir, const guint8 **data, gsize *size)
+{
+	guint16 counts[2];
+	guint i;
+
+	if (*size < sizeof(counts))
+		return FALSE;
+	memcpy(counts, *data, sizeof(counts));
+	*data += sizeof(counts);
+	*size -= sizeof(counts);
+
+	if (*size < counts[0] * sizeof(guint32))
+		return FALSE;
+	for (i = 0; i < counts[0]; ++i) {
+		guint32 entry;
+		guint key;
+
+		memcpy(&entry, *data, sizeof(entry));
+		key = entry >> ENTRY_KEY_SHIFT;
+		dir->values[key] = entry & ENTRY_VALUE_MASK;
+		dir->present[key / 32] |= 1u << (key % 32);
+		*data += sizeof(entry);
+		*size -= sizeof(entry);
+	}
+
+	for (i = 0; i < counts[1]; ++i) {
+		guint16 length;
+		gsize padded;
+		guint key;
+
+		if (*size < 4)
+			return FALSE;
+		key = (*data)[0];
+		memcpy(&length, *data + 2, sizeof(length));
+		padded = length + (4 - length % 4) % 4;
+		if (*size < 4 + padded || dir->texts[key] != NULL)
+			return FALSE;
+
+		dir->texts[key] = g_strndup((const gchar *)*data + 4, length);
+		*data += 4 + padded;
+		*size -= 4 + padded;
+	}
+
+	return TRUE;
+}
+
+// Internal use only. Serialize the index without the content. The caller should keep the content
+// to deserialize it.
+void hinawa_config_rom_serialize(const HinawaConfigRom *self, GByteArray *buf)
+{
+	guint32 unit_count = self->unit_count;
+	guint i;
+
+	g_byte_array_append(buf, (const guint8 *)&unit_count, sizeof(unit_count));
+	serialize_directory(&self->root, buf);
+	for (i = 0; i < self->unit_count; ++i)
+		serialize_directory(&self->units[i], buf);
+}
+
+// Internal use only. Build the index from the serialized form without parsing the content.
+// Return NULL when the serialized form is malformed.
+HinawaConfigRom *hinawa_config_rom_deserialize(GBytes *image, const guint8 *data, gsize size)
+{
+	HinawaConfigRom *self;
+	guint32 unit_count;
+	guint i;
+
+	if (size < sizeof(unit_count))
+		return NULL;
+	memcpy(&unit_count, data, sizeof(unit_count));
+	data += sizeof(unit_count);
+	size -= sizeof(unit_count);
+
+	// Each directory consumes at least 4 bytes.
+	if (unit_count > size / 4)
+		return NULL;
+
+	self = g_malloc0(sizeof(*self));
+	self->ref_count = 1;
+	self->image = g_bytes_ref(image);
+	self->has_guid = hinawa_config_rom_parse_guid(image, &self->guid);
+	self->unit_count = unit_count;
+	self->units = g_new0(struct directory, unit_count);
+
+	if (!deserialize_directory(&self->root, &data, &size)) {
+		hinawa_config_rom_unref(self);
+		return NULL;
+	}
+	for (i = 0; i < unit_count; ++i) {
+		if (!deserialize_directory(&self->units[i], &data, &size)) {
+			hinawa_config_rom_unref(self);
+			return NULL;
+		}
+	}
+
+	return self;
+}
+
+/**
+ * hinawa_config_rom_new:
+ * @image: The content of configuration ROM aligned to big-endian.
+ *
+ * Allocate and return an instance of [struct@ConfigRom] with the index built from the given
+ * content. The malformed part of content is just skipped.
+ *
+ * Returns: (transfer full): An instance of [struct@ConfigRom].
+ *
+ * Since: 4.1
+ */
+HinawaConfigRom *hinawa_config_rom_new(GBytes *image)
+{
+	HinawaConfigRom *self;
+	const guint8 *data;
+	gsize size;
+	gsize quads;
+	GArray *unit_offsets;
+	guint info_length;
+	guint i;
+
+	g_return_val_if_fail(image != NULL, NULL);
+
+	self = g_malloc0(sizeof(*self));
+	self->ref_count = 1;
+	self->image = g_bytes_ref(image);
+
+	data = g_bytes_get_data(image, &size);
+	quads = size / 4;
+	if (quads == 0)
+		return self;
+
+	info_length = read_quadlet(data, 0) >> BUS_INFO_LENGTH_SHIFT;
+	self->has_guid = hinawa_config_rom_parse_guid(image, &self->guid);
+
+	unit_offsets = g_array_new(FALSE, FALSE, sizeof(guint64));
+	parse_directory(data, quads, 1 + info_length, &self->root, unit_offsets);
+
+	self->unit_count = unit_offsets->len;
+	self->units = g_new0(struct directory, self->unit_count);
+	for (i = 0; i < self->unit_count; ++i) {
+		guint64 offset = g_array_index(unit_offsets, guint64, i);
+		parse_directory(data, quads, offset, &self->units[i], NULL);
+	}
+	g_array_free(unit_offsets, TRUE);
+
+	return self;
+}
+
+/**
+ * hinawa_config_rom_ref:
+ * @self: A [struct@ConfigRom].
+ *
+ * Take the reference of the instance.
+ *
+ * Returns: (transfer full): The instance.
+ *
+ * Since: 4.1
+ */
+HinawaConfigRom *hinawa_config_rom_ref(HinawaConfigRom *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+
+	g_atomic_int_inc(&self->ref_count);
+
+	return self;
+}
+
+/**
+ * hinawa_config_rom_unref:
+ * @self: A [struct@ConfigRom].
+ *
+ * Release the reference of the instance. The instance is released when no reference remains.
+ *
+ * Since: 4.1
+ */
+void hinawa_config_rom_unref(HinawaConfigRom *self)
+{
+	guint i;
+
+	g_return_if_fail(self != NULL);
+
+	if (!g_atomic_int_dec_and_test(&self->ref_count))
+		return;
+
+	clear_directory(&self->root);
+	for (i = 0; i < self->unit_count; ++i)
+		clear_directory(&self->units[i]);
+	g_free(self->units);
+	g_bytes_unref(self->image);
+	g_free(self);
+}
+
+/**
+ * hinawa_config_rom_get_image:
+ * @self: A [struct@ConfigRom].
+ *
+ * Get the content of configuration ROM from which the index is built.
+ *
+ * Returns: (transfer none): The content of configuration ROM aligned to big-endian.
+ *
+ * Since: 4.1
+ */
+GBytes *hinawa_config_rom_get_image(const HinawaConfigRom *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+
+	return self->image;
+}
+
+/**
+ * hinawa_config_rom_get_guid:
+ * @self: A [struct@ConfigRom].
+ * @guid: (out): The global unique ID in bus information block.
+ *
+ * Get the global unique ID, which consists of node vendor ID and chip ID in bus information
+ * block.
+ *
+ * Returns: TRUE if the bus information block includes the ID, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_get_guid(const HinawaConfigRom *self, guint64 *guid)
+{
+	g_return_val_if_fail(self != NULL, FALSE);
+	g_return_val_if_fail(guid != NULL, FALSE);
+
+	*guid = self->guid;
+
+	return self->has_guid;
+}
+
+/**
+ * hinawa_config_rom_get_root_entry:
+ * @self: A [struct@ConfigRom].
+ * @key: The key of entry, including key type and key ID.
+ * @value: (out): The value of entry in lower 24 bits.
+ *
+ * Get the value of entry in root directory. When the key appears several times in the
+ * directory, the value of first entry is available.
+ *
+ * Returns: TRUE if the entry is found, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_get_root_entry(const HinawaConfigRom *self, guint key, guint32 *value)
+{
+	g_return_val_if_fail(self != NULL, FALSE);
+	g_return_val_if_fail(key < KEY_COUNT, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+
+	if (!directory_has_entry(&self->root, key))
+		return FALSE;
+
+	*value = self->root.values[key];
+
+	return TRUE;
+}
+
+/**
+ * hinawa_config_rom_get_root_text:
+ * @self: A [struct@ConfigRom].
+ * @key: The key of entry, including key type and key ID.
+ *
+ * Get the text in the textual descriptor leaf which describes the entry in root directory. Just
+ * minimal ASCII form is supported.
+ *
+ * Returns: (transfer none)(nullable): The text, or %NULL if not found.
+ *
+ * Since: 4.1
+ */
+const gchar *hinawa_config_rom_get_root_text(const HinawaConfigRom *self, guint key)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	g_return_val_if_fail(key < KEY_COUNT, NULL);
+
+	return self->root.texts[key];
+}
+
+/**
+ * hinawa_config_rom_get_unit_count:
+ * @self: A [struct@ConfigRom].
+ *
+ * Get the number of unit directories referred by root directory.
+ *
+ * Returns: The number of unit directories.
+ *
+ * Since: 4.1
+ */
+guint hinawa_config_rom_get_unit_count(const HinawaConfigRom *self)
+{
+	g_return_val_if_fail(self != NULL, 0);
+
+	return self->unit_count;
+}
+
+/**
+ * hinawa_config_rom_get_unit_entry:
+ * @self: A [struct@ConfigRom].
+ * @unit: The index of unit directory in order of appearance in root directory.
+ * @key: The key of entry, including key type and key ID.
+ * @value: (out): The value of entry in lower 24 bits.
+ *
+ * Get the value of entry in the unit directory.
+ *
+ * Returns: TRUE if the entry is found, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_get_unit_entry(const HinawaConfigRom *self, guint unit, guint key,
+					  guint32 *value)
+{
+	g_return_val_if_fail(self != NULL, FALSE);
+	g_return_val_if_fail(unit < self->unit_count, FALSE);
+	g_return_val_if_fail(key < KEY_COUNT, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+
+	if (!directory_has_entry(&self->units[unit], key))
+		return FALSE;
+
+	*value = self->units[unit].values[key];
+
+	return TRUE;
+}
+
+/**
+ * hinawa_config_rom_get_unit_text:
+ * @self: A [struct@ConfigRom].
+ * @unit: The index of unit directory in order of appearance in root directory.
+ * @key: The key of entry, including key type and key ID.
+ *
+ * Get the text in the textual descriptor leaf which describes the entry in the unit directory.
+ * Just minimal ASCII form is supported.
+ *
+ * Returns: (transfer none)(nullable): The text, or %NULL if not found.
+ *
+ * Since: 4.1
+ */
+const gchar *hinawa_config_rom_get_unit_text(const HinawaConfigRom *self, guint unit, guint key)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	g_return_val_if_fail(unit < self->unit_count, NULL);
+	g_return_val_if_fail(key < KEY_COUNT, NULL);
+
+	return self->units[unit].texts[key];
+}
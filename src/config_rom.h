@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#ifndef __ORG_KERNEL_HINAWA_CONFIG_ROM_H__
+#define __ORG_KERNEL_HINAWA_CONFIG_ROM_H__
+
+#include <hinawa.h>
+
+G_BEGIN_DECLS
+
+#define HINAWA_TYPE_CONFIG_ROM		(hinawa_config_rom_get_type())
+
+typedef struct _HinawaConfigRom HinawaConfigRom;
+
+GType hinawa_config_rom_get_type() G_GNUC_CONST;
+
+HinawaConfigRom *hinawa_config_rom_new(GBytes *image);
+
+HinawaConfigRom *hinawa_config_rom_ref(HinawaConfigRom *self);
+
+void hinawa_config_rom_unref(HinawaConfigRom *self);
+
+GBytes *hinawa_config_rom_get_image(const HinawaConfigRom *self);
+
+gboolean hinawa_config_rom_get_guid(const HinawaConfigRom *self, guint64 *guid);
+
+gboolean hinawa_config_rom_get_root_entry(const HinawaConfigRom *self, guint key, guint32 *value);
+
+const gchar *hinawa_config_rom_get_root_text(const HinawaConfigRom *self, guint key);
+
+guint hinawa_config_rom_get_unit_count(const HinawaConfigRom *self);
+
+gboolean hinawa_config_rom_get_unit_entry(const HinawaConfigRom *self, guint unit, guint key,
+					  guint32 *value);
+
+const gchar *hinawa_config_rom_get_unit_text(const HinawaConfigRom *self, guint unit, guint key);
+
+G_END_DECLS
+
+#endif
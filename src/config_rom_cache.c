@@ -0,0 +1,452 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+
+/**
+ * HinawaConfigRomCache:
+ * A persistent cache of index of configuration ROM keyed by global unique ID.
+ *
+ * [class@ConfigRomCache] keeps [struct@ConfigRom] together with the classification of device
+ * defined by application in a file. The file is mapped to memory at load, then the lookup of
+ * index is done without parsing content of configuration ROM. The cached index is validated by
+ * the hash of the content, thus it is rejected when the content is changed. The new index is
+ * written into the file at save, while the other indexes are copied as they are.
+ *
+ * The file is in host-endian, thus it should not be shared between systems.
+ *
+ * Since: 4.1
+ */
+
+#define CACHE_MAGIC		"HNWROMC"
+#define CACHE_VERSION		1
+
+struct cache_header {
+	gchar magic[8];
+	guint32 version;
+	guint32 record_count;
+};
+
+// Sorted by global unique ID for binary search.
+struct cache_slot {
+	guint64 guid;
+	guint64 offset;
+	guint64 length;
+};
+
+// Followed by the serialized index.
+struct cache_record {
+	guint64 hash;
+	guint32 classification;
+	guint32 reserved;
+};
+
+struct pending_record {
+	guint64 guid;
+	guint64 hash;
+	guint32 classification;
+	HinawaConfigRom *index;
+};
+
+typedef struct {
+	GMutex mutex;
+	gchar *path;
+
+	GMappedFile *mapped;
+	const guint8 *data;
+	gsize length;
+	const struct cache_slot *slots;
+	guint slot_count;
+
+	GHashTable *pending;
+} HinawaConfigRomCachePrivate;
+G_DEFINE_TYPE_WITH_PRIVATE(HinawaConfigRomCache, hinawa_config_rom_cache, G_TYPE_OBJECT)
+
+static void free_pending_record(gpointer data)
+{
+	struct pending_record *record = data;
+
+	hinawa_config_rom_unref(record->index);
+	g_free(record);
+}
+
+static void release_mapped_file(HinawaConfigRomCachePrivate *priv)
+{
+	if (priv->mapped != NULL)
+		g_mapped_file_unref(priv->mapped);
+	priv->mapped = NULL;
+	priv->data = NULL;
+	priv->length = 0;
+	priv->slots = NULL;
+	priv->slot_count = 0;
+}
+
+static void config_rom_cache_finalize(GObject *obj)
+{
+	HinawaConfigRomCache *self = HINAWA_CONFIG_ROM_CACHE(obj);
+	HinawaConfigRomCachePrivate *priv = hinawa_config_rom_cache_get_instance_private(self);
+
+	release_mapped_file(priv);
+	g_hash_table_unref(priv->pending);
+	g_free(priv->path);
+	g_mutex_clear(&priv->mutex);
+
+	G_OBJECT_CLASS(hinawa_config_rom_cache_parent_class)->finalize(obj);
+}
+
+static void hinawa_config_rom_cache_class_init(HinawaConfigRomCacheClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = config_rom_cache_finalize;
+}
+
+static void hinawa_config_rom_cache_init(HinawaConfigRomCache *self)
+{
+	HinawaConfigRomCachePrivate *priv = hinawa_config_rom_cache_get_instance_private(self);
+
+	g_mutex_init(&priv->mutex);
+	priv->pending = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+					      free_pending_record);
+}
+
+/**
+ * hinawa_config_rom_cache_new:
+ *
+ * Instantiate [class@ConfigRomCache] object and return the instance.
+ *
+ * Returns: an instance of [class@ConfigRomCache].
+ * Since: 4.1
+ */
+HinawaConfigRomCache *hinawa_config_rom_cache_new(void)
+{
+	return g_object_new(HINAWA_TYPE_CONFIG_ROM_CACHE, NULL);
+}
+
+// The malformed file is handled as empty so that it is rebuilt at next save.
+static void map_file(HinawaConfigRomCachePrivate *priv, GMappedFile *mapped)
+{
+	const struct cache_header *header;
+	const guint8 *data = (const guint8 *)g_mapped_file_get_contents(mapped);
+	gsize length = g_mapped_file_get_length(mapped);
+
+	if (length < sizeof(*header)) {
+		g_mapped_file_unref(mapped);
+		return;
+	}
+
+	header = (const struct cache_header *)data;
+	if (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+	    header->version != CACHE_VERSION ||
+	    header->record_count > (length - sizeof(*header)) / sizeof(struct cache_slot)) {
+		g_mapped_file_unref(mapped);
+		return;
+	}
+
+	priv->mapped = mapped;
+	priv->data = data;
+	priv->length = length;
+	priv->slots = (const struct cache_slot *)(data + sizeof(*header));
+	priv->slot_count = header->record_count;
+}
+
+/**
+ * hinawa_config_rom_cache_load:
+ * @self: A [class@ConfigRomCache].
+ * @path: The path to the file of cache.
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@GLib.FileError].
+ *
+ * Map the file of cache to memory. The file is written at [method@ConfigRomCache.save]. The
+ * absent or malformed file is handled as empty cache.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_cache_load(HinawaConfigRomCache *self, const gchar *path,
+				      GError **error)
+{
+	HinawaConfigRomCachePrivate *priv;
+	GMappedFile *mapped;
+	GError *local_error = NULL;
+
+	g_return_val_if_fail(HINAWA_IS_CONFIG_ROM_CACHE(self), FALSE);
+	g_return_val_if_fail(path != NULL && strlen(path) > 0, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_config_rom_cache_get_instance_private(self);
+
+	mapped = g_mapped_file_new(path, FALSE, &local_error);
+	if (mapped == NULL && !g_error_matches(local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+		g_propagate_error(error, local_error);
+		return FALSE;
+	}
+	g_clear_error(&local_error);
+
+	g_mutex_lock(&priv->mutex);
+
+	release_mapped_file(priv);
+	g_hash_table_remove_all(priv->pending);
+	g_free(priv->path);
+	priv->path = g_strdup(path);
+
+	if (mapped != NULL)
+		map_file(priv, mapped);
+
+	g_mutex_unlock(&priv->mutex);
+
+	return TRUE;
+}
+
+static const struct cache_slot *find_slot(HinawaConfigRomCachePrivate *priv, guint64 guid)
+{
+	guint lower = 0;
+	guint upper = priv->slot_count;
+
+	while (lower < upper) {
+		guint middle = lower + (upper - lower) / 2;
+		const struct cache_slot *slot = priv->slots + middle;
+
+		if (slot->guid == guid)
+			return slot;
+		else if (slot->guid < guid)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	return NULL;
+}
+
+static const struct cache_record *parse_slot(HinawaConfigRomCachePrivate *priv,
+					     const struct cache_slot *slot)
+{
+	if (slot->offset > priv->length || slot->length > priv->length - slot->offset ||
+	    slot->length < sizeof(struct cache_record) || slot->offset % 8 > 0)
+		return NULL;
+
+	return (const struct cache_record *)(priv->data + slot->offset);
+}
+
+/**
+ * hinawa_config_rom_cache_lookup:
+ * @self: A [class@ConfigRomCache].
+ * @image: The content of configuration ROM aligned to big-endian, typically retrieved by
+ *	   [method@FwNode.get_config_rom_bytes].
+ * @index: (out)(transfer full)(nullable): The cached index for the content.
+ * @classification: (out)(optional): The classification of device given at insertion.
+ *
+ * Look up the index cached for the global unique ID in the content. The cached index is
+ * available only when the hash of content is the same as the one at insertion.
+ *
+ * Returns: TRUE if the cached index is available, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_cache_lookup(HinawaConfigRomCache *self, GBytes *image,
+					HinawaConfigRom **index, guint32 *classification)
+{
+	HinawaConfigRomCachePrivate *priv;
+	const struct pending_record *pending;
+	const struct cache_slot *slot;
+	const struct cache_record *record;
+	guint64 guid;
+	guint64 hash;
+
+	g_return_val_if_fail(HINAWA_IS_CONFIG_ROM_CACHE(self), FALSE);
+	g_return_val_if_fail(image != NULL, FALSE);
+	g_return_val_if_fail(index != NULL, FALSE);
+
+	priv = hinawa_config_rom_cache_get_instance_private(self);
+	*index = NULL;
+
+	if (!hinawa_config_rom_parse_guid(image, &guid))
+		return FALSE;
+	hash = hinawa_config_rom_compute_hash(image);
+
+	g_mutex_lock(&priv->mutex);
+
+	pending = g_hash_table_lookup(priv->pending, &guid);
+	if (pending != NULL) {
+		if (pending->hash == hash) {
+			*index = hinawa_config_rom_ref(pending->index);
+			if (classification != NULL)
+				*classification = pending->classification;
+		}
+	} else {
+		slot = find_slot(priv, guid);
+		if (slot != NULL) {
+			record = parse_slot(priv, slot);
+			if (record != NULL && record->hash == hash) {
+				*index = hinawa_config_rom_deserialize(image,
+						(const guint8 *)(record + 1),
+						slot->length - sizeof(*record));
+				if (*index != NULL && classification != NULL)
+					*classification = record->classification;
+			}
+		}
+	}
+
+	g_mutex_unlock(&priv->mutex);
+
+	return *index != NULL;
+}
+
+/**
+ * hinawa_config_rom_cache_insert:
+ * @self: A [class@ConfigRomCache].
+ * @index: The index of configuration ROM, which includes global unique ID.
+ * @classification: The classification of device defined by application.
+ *
+ * Insert the index to the cache. The index replaces the one cached for the same global unique
+ * ID. It is written into the file at [method@ConfigRomCache.save].
+ *
+ * Since: 4.1
+ */
+void hinawa_config_rom_cache_insert(HinawaConfigRomCache *self, HinawaConfigRom *index,
+				    guint32 classification)
+{
+	HinawaConfigRomCachePrivate *priv;
+	struct pending_record *record;
+	guint64 guid;
+
+	g_return_if_fail(HINAWA_IS_CONFIG_ROM_CACHE(self));
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(hinawa_config_rom_get_guid(index, &guid));
+
+	priv = hinawa_config_rom_cache_get_instance_private(self);
+
+	record = g_malloc(sizeof(*record));
+	record->guid = guid;
+	record->hash = hinawa_config_rom_compute_hash(hinawa_config_rom_get_image(index));
+	record->classification = classification;
+	record->index = hinawa_config_rom_ref(index);
+
+	g_mutex_lock(&priv->mutex);
+	g_hash_table_replace(priv->pending, &record->guid, record);
+	g_mutex_unlock(&priv->mutex);
+}
+
+static gint compare_slot(gconstpointer a, gconstpointer b)
+{
+	const struct cache_slot *lhs = a;
+	const struct cache_slot *rhs = b;
+
+	return (lhs->guid > rhs->guid) - (lhs->guid < rhs->guid);
+}
+
+static void append_record(GByteArray *records, struct cache_slot *slot, const guint8 *record,
+			  gsize length)
+{
+	static const guint8 padding[8] = {0};
+
+	slot->offset = records->len;
+	slot->length = length;
+	g_byte_array_append(records, record, length);
+	g_byte_array_append(records, padding, (8 - length % 8) % 8);
+}
+
+/**
+ * hinawa_config_rom_cache_save:
+ * @self: A [class@ConfigRomCache].
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@GLib.FileError].
+ *
+ * Write the cache into the file given at [method@ConfigRomCache.load]. The indexes inserted
+ * since the load are serialized, while the others are copied from the mapped file as they are.
+ * The file is replaced atomically, then mapped again.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_config_rom_cache_save(HinawaConfigRomCache *self, GError **error)
+{
+	HinawaConfigRomCachePrivate *priv;
+	struct cache_header header = {0};
+	GArray *slots;
+	GByteArray *records;
+	GByteArray *buf;
+	GHashTableIter iter;
+	gpointer value;
+	gsize records_offset;
+	GMappedFile *mapped;
+	gboolean result;
+	guint i;
+
+	g_return_val_if_fail(HINAWA_IS_CONFIG_ROM_CACHE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_config_rom_cache_get_instance_private(self);
+	g_return_val_if_fail(priv->path != NULL, FALSE);
+
+	slots = g_array_new(FALSE, TRUE, sizeof(struct cache_slot));
+	records = g_byte_array_new();
+
+	g_mutex_lock(&priv->mutex);
+
+	// Copy the records as they are unless replaced.
+	for (i = 0; i < priv->slot_count; ++i) {
+		const struct cache_slot *slot = priv->slots + i;
+		struct cache_slot entry = { .guid = slot->guid };
+
+		if (g_hash_table_contains(priv->pending, &slot->guid) ||
+		    parse_slot(priv, slot) == NULL)
+			continue;
+
+		append_record(records, &entry, priv->data + slot->offset, slot->length);
+		g_array_append_val(slots, entry);
+	}
+
+	g_hash_table_iter_init(&iter, priv->pending);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		const struct pending_record *pending = value;
+		struct cache_record record = {
+			.hash = pending->hash,
+			.classification = pending->classification,
+		};
+		struct cache_slot entry = { .guid = pending->guid };
+		GByteArray *payload = g_byte_array_new();
+
+		g_byte_array_append(payload, (const guint8 *)&record, sizeof(record));
+		hinawa_config_rom_serialize(pending->index, payload);
+		append_record(records, &entry, payload->data, payload->len);
+		g_array_append_val(slots, entry);
+		g_byte_array_unref(payload);
+	}
+
+	g_array_sort(slots, compare_slot);
+
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.record_count = slots->len;
+
+	// The records are aligned to 8 bytes.
+	records_offset = sizeof(header) + slots->len * sizeof(struct cache_slot);
+	for (i = 0; i < slots->len; ++i)
+		g_array_index(slots, struct cache_slot, i).offset += records_offset;
+
+	buf = g_byte_array_sized_new(records_offset + records->len);
+	g_byte_array_append(buf, (const guint8 *)&header, sizeof(header));
+	g_byte_array_append(buf, (const guint8 *)slots->data,
+			    slots->len * sizeof(struct cache_slot));
+	g_byte_array_append(buf, records->data, records->len);
+
+	result = g_file_set_contents(priv->path, (const gchar *)buf->data, buf->len, error);
+	if (result) {
+		mapped = g_mapped_file_new(priv->path, FALSE, error);
+		result = mapped != NULL;
+		if (result) {
+			release_mapped_file(priv);
+			g_hash_table_remove_all(priv->pending);
+			map_file(priv, mapped);
+		}
+	}
+
+	g_mutex_unlock(&priv->mutex);
+
+	g_byte_array_unref(buf);
+	g_byte_array_unref(records);
+	g_array_unref(slots);
+
+	return result;
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#ifndef __ORG_KERNEL_HINAWA_CONFIG_ROM_CACHE_H__
+#define __ORG_KERNEL_HINAWA_CONFIG_ROM_CACHE_H__
+
+#include <hinawa.h>
+
+G_BEGIN_DECLS
+
+#define HINAWA_TYPE_CONFIG_ROM_CACHE	(hinawa_config_rom_cache_get_type())
+
+G_DECLARE_DERIVABLE_TYPE(HinawaConfigRomCache, hinawa_config_rom_cache, HINAWA, CONFIG_ROM_CACHE,
+			 GObject)
+
+struct _HinawaConfigRomCacheClass {
+	GObjectClass parent_class;
+};
+
+HinawaConfigRomCache *hinawa_config_rom_cache_new(void);
+
+gboolean hinawa_config_rom_cache_load(HinawaConfigRomCache *self, const gchar *path,
+				      GError **error);
+
+gboolean hinawa_config_rom_cache_lookup(HinawaConfigRomCache *self, GBytes *image,
+					HinawaConfigRom **index, guint32 *classification);
+
+void hinawa_config_rom_cache_insert(HinawaConfigRomCache *self, HinawaConfigRom *index,
+				    guint32 classification);
+
+gboolean hinawa_config_rom_cache_save(HinawaConfigRomCache *self, GError **error);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+
+/**
+ * HinawaFwDispatcher:
+ * An event dispatcher for multiple nodes in IEEE 1394 bus.
+ *
+ * [class@FwDispatcher] dispatches events for multiple instances of [class@FwNode] by a single
+ * [struct@GLib.Source]. The file descriptors of nodes are registered to one epoll instance, thus
+ * the source polls the single file descriptor, and processes events only for nodes which have
+ * queued events.
+ *
+ * Since: 4.1
+ */
+
+typedef struct {
+	int epfd;
+	// The error number at the failure to create epoll instance.
+	int epoll_errno;
+
+	GHashTable *nodes;
+	GMutex mutex;
+} HinawaFwDispatcherPrivate;
+G_DEFINE_TYPE_WITH_PRIVATE(HinawaFwDispatcher, hinawa_fw_dispatcher, G_TYPE_OBJECT)
+
+// The maximum number of nodes processed in a single dispatch of the source.
+#define MAX_READY_NODES		32
+
+typedef struct {
+	GSource src;
+	HinawaFwDispatcher *self;
+	gpointer tag;
+} FwDispatcherSource;
+
+static void fw_dispatcher_finalize(GObject *obj)
+{
+	HinawaFwDispatcher *self = HINAWA_FW_DISPATCHER(obj);
+	HinawaFwDispatcherPrivate *priv = hinawa_fw_dispatcher_get_instance_private(self);
+
+	g_hash_table_unref(priv->nodes);
+	if (priv->epfd >= 0)
+		close(priv->epfd);
+	g_mutex_clear(&priv->mutex);
+
+	G_OBJECT_CLASS(hinawa_fw_dispatcher_parent_class)->finalize(obj);
+}
+
+static void hinawa_fw_dispatcher_class_init(HinawaFwDispatcherClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = fw_dispatcher_finalize;
+}
+
+static void hinawa_fw_dispatcher_init(HinawaFwDispatcher *self)
+{
+	HinawaFwDispatcherPrivate *priv = hinawa_fw_dispatcher_get_instance_private(self);
+
+	priv->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (priv->epfd < 0)
+		priv->epoll_errno = errno;
+	priv->nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal, g_object_unref, NULL);
+	g_mutex_init(&priv->mutex);
+}
+
+/**
+ * hinawa_fw_dispatcher_new:
+ *
+ * Instantiate [class@FwDispatcher] object and return the instance.
+ *
+ * Returns: an instance of [class@FwDispatcher].
+ * Since: 4.1
+ */
+HinawaFwDispatcher *hinawa_fw_dispatcher_new(void)
+{
+	return g_object_new(HINAWA_TYPE_FW_DISPATCHER, NULL);
+}
+
+/**
+ * hinawa_fw_dispatcher_add_node:
+ * @self: A [class@FwDispatcher].
+ * @node: A [class@FwNode].
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
+ *
+ * Add the node to the set of nodes for which the source dispatches events. The node should not
+ * be dispatched by the other ways at the same time, such as the source retrieved by
+ * [method@FwNode.create_source].
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_dispatcher_add_node(HinawaFwDispatcher *self, HinawaFwNode *node,
+				       GError **error)
+{
+	HinawaFwDispatcherPrivate *priv;
+	struct epoll_event ev = {0};
+	gboolean result = TRUE;
+	int fd;
+
+	g_return_val_if_fail(HINAWA_IS_FW_DISPATCHER(self), FALSE);
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(node), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_dispatcher_get_instance_private(self);
+	if (priv->epfd < 0) {
+		generate_syscall_error(error, priv->epoll_errno, "epoll_create1(%s)",
+				       "EPOLL_CLOEXEC");
+		return FALSE;
+	}
+
+	fd = hinawa_fw_node_get_fd(node);
+	if (fd < 0) {
+		g_set_error_literal(error, HINAWA_FW_NODE_ERROR, HINAWA_FW_NODE_ERROR_NOT_OPENED,
+				    "The instance is not associated to node");
+		return FALSE;
+	}
+
+	g_mutex_lock(&priv->mutex);
+
+	if (!g_hash_table_contains(priv->nodes, node)) {
+		ev.events = EPOLLIN;
+		ev.data.ptr = node;
+		if (epoll_ctl(priv->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			generate_syscall_error(error, errno, "epoll_ctl(%s)", "EPOLL_CTL_ADD");
+			result = FALSE;
+		} else {
+			g_hash_table_add(priv->nodes, g_object_ref(node));
+		}
+	}
+
+	g_mutex_unlock(&priv->mutex);
+
+	return result;
+}
+
+static void remove_node(HinawaFwDispatcherPrivate *priv, HinawaFwNode *node)
+{
+	int fd = hinawa_fw_node_get_fd(node);
+
+	// Ignore error since the file descriptor may be already closed.
+	if (fd >= 0)
+		epoll_ctl(priv->epfd, EPOLL_CTL_DEL, fd, NULL);
+	g_hash_table_remove(priv->nodes, node);
+}
+
+/**
+ * hinawa_fw_dispatcher_remove_node:
+ * @self: A [class@FwDispatcher].
+ * @node: A [class@FwNode].
+ *
+ * Remove the node from the set of nodes for which the source dispatches events.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_dispatcher_remove_node(HinawaFwDispatcher *self, HinawaFwNode *node)
+{
+	HinawaFwDispatcherPrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_DISPATCHER(self));
+	g_return_if_fail(HINAWA_IS_FW_NODE(node));
+	priv = hinawa_fw_dispatcher_get_instance_private(self);
+
+	g_mutex_lock(&priv->mutex);
+	if (g_hash_table_contains(priv->nodes, node))
+		remove_node(priv, node);
+	g_mutex_unlock(&priv->mutex);
+}
+
+static gboolean check_src(GSource *gsrc)
+{
+	FwDispatcherSource *src = (FwDispatcherSource *)gsrc;
+	GIOCondition condition;
+
+	condition = g_source_query_unix_fd(gsrc, src->tag);
+	return !!(condition & (G_IO_IN | G_IO_ERR));
+}
+
+static gboolean dispatch_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+{
+	FwDispatcherSource *src = (FwDispatcherSource *)gsrc;
+	HinawaFwDispatcherPrivate *priv = hinawa_fw_dispatcher_get_instance_private(src->self);
+	struct epoll_event evs[MAX_READY_NODES];
+	HinawaFwNode *nodes[MAX_READY_NODES];
+	GIOCondition conditions[MAX_READY_NODES];
+	int count;
+	int i;
+
+	// Retrieve the nodes with queued events. The reference is kept during processing the
+	// events so that the node can be removed by the other thread.
+	g_mutex_lock(&priv->mutex);
+	count = epoll_wait(priv->epfd, evs, G_N_ELEMENTS(evs), 0);
+	for (i = 0; i < count; ++i) {
+		nodes[i] = g_object_ref(evs[i].data.ptr);
+
+		conditions[i] = 0;
+		if (evs[i].events & EPOLLIN)
+			conditions[i] |= G_IO_IN;
+		if (evs[i].events & EPOLLERR)
+			conditions[i] |= G_IO_ERR;
+		if (evs[i].events & EPOLLHUP)
+			conditions[i] |= G_IO_HUP;
+	}
+	g_mutex_unlock(&priv->mutex);
+
+	if (count < 0) {
+		if (errno == EINTR)
+			return G_SOURCE_CONTINUE;
+		return G_SOURCE_REMOVE;
+	}
+
+	for (i = 0; i < count; ++i) {
+		if (!hinawa_fw_node_dispatch(nodes[i], conditions[i])) {
+			g_mutex_lock(&priv->mutex);
+			if (g_hash_table_contains(priv->nodes, nodes[i]))
+				remove_node(priv, nodes[i]);
+			g_mutex_unlock(&priv->mutex);
+		}
+		g_object_unref(nodes[i]);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void finalize_src(GSource *gsrc)
+{
+	FwDispatcherSource *src = (FwDispatcherSource *)gsrc;
+
+	g_object_unref(src->self);
+}
+
+/**
+ * hinawa_fw_dispatcher_create_source:
+ * @self: A [class@FwDispatcher].
+ * @gsrc: (out): A [struct@GLib.Source].
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
+ *
+ * Create [struct@GLib.Source] for [struct@GLib.MainContext] to dispatch events for the nodes
+ * added by [method@FwDispatcher.add_node]. The number of events processed for each node in a
+ * single dispatch is limited by [property@FwNode:dispatch-event-budget] and
+ * [property@FwNode:dispatch-time-budget]. When a node is disconnected, the node is removed
+ * from the set after emitting [signal@FwNode::disconnected].
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_dispatcher_create_source(HinawaFwDispatcher *self, GSource **gsrc,
+					    GError **error)
+{
+	static GSourceFuncs funcs = {
+		.check		= check_src,
+		.dispatch	= dispatch_src,
+		.finalize	= finalize_src,
+	};
+	HinawaFwDispatcherPrivate *priv;
+	FwDispatcherSource *src;
+
+	g_return_val_if_fail(HINAWA_IS_FW_DISPATCHER(self), FALSE);
+	g_return_val_if_fail(gsrc != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_dispatcher_get_instance_private(self);
+	if (priv->epfd < 0) {
+		generate_syscall_error(error, priv->epoll_errno, "epoll_create1(%s)",
+				       "EPOLL_CLOEXEC");
+		return FALSE;
+	}
+
+	*gsrc = g_source_new(&funcs, sizeof(FwDispatcherSource));
+	src = (FwDispatcherSource *)(*gsrc);
+
+	g_source_set_name(*gsrc, "HinawaFwDispatcher");
+
+	src->self = g_object_ref(self);
+	src->tag = g_source_add_unix_fd(*gsrc, priv->epfd, G_IO_IN);
+
+	return TRUE;
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#ifndef __ORG_KERNEL_HINAWA_FW_DISPATCHER_H__
+#define __ORG_KERNEL_HINAWA_FW_DISPATCHER_H__
+
+#include <hinawa.h>
+
+G_BEGIN_DECLS
+
+#define HINAWA_TYPE_FW_DISPATCHER	(hinawa_fw_dispatcher_get_type())
+
+G_DECLARE_DERIVABLE_TYPE(HinawaFwDispatcher, hinawa_fw_dispatcher, HINAWA, FW_DISPATCHER, GObject)
+
+struct _HinawaFwDispatcherClass {
+	GObjectClass parent_class;
+};
+
+HinawaFwDispatcher *hinawa_fw_dispatcher_new(void);
+
+gboolean hinawa_fw_dispatcher_add_node(HinawaFwDispatcher *self, HinawaFwNode *node,
+				       GError **error);
+
+void hinawa_fw_dispatcher_remove_node(HinawaFwDispatcher *self, HinawaFwNode *node);
+
+gboolean hinawa_fw_dispatcher_create_source(HinawaFwDispatcher *self, GSource **gsrc,
+					    GError **error);
+
+G_END_DECLS
+
+#endif
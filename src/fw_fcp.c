@@ -195,6 +195,9 @@ static void hinawa_fw_fcp_class_init(HinawaFwFcpClass *klass)
 			     hinawa_sigs_marshal_VOID__UINT_UINT_POINTER_UINT,
 			     G_TYPE_NONE,
 			     4, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_UINT);
+	g_signal_set_va_marshaller(fw_fcp_sigs[FW_FCP_SIG_TYPE_RESPONDED],
+				   G_OBJECT_CLASS_TYPE(klass),
+				   hinawa_sigs_marshal_VOID__UINT_UINT_POINTER_UINTv);
 }
 
 static void node_history_init(struct node_history *history);
@@ -316,8 +319,9 @@ struct waiter {
 	LIST_ENTRY(waiter) list;
 };
 
-static void handle_responded_signal(HinawaFwFcp *self, guint generation, guint tstamp,
-				    const guint8 *frame, guint frame_size)
+// The waiters are notified directly without emission of signal.
+static void notify_waiters(HinawaFwFcp *self, guint generation, guint tstamp,
+			   const guint8 *frame, guint frame_size)
 {
 	HinawaFwFcpPrivate *priv = hinawa_fw_fcp_get_instance_private(self);
 	struct waiter *w;
@@ -328,6 +332,11 @@ static void handle_responded_signal(HinawaFwFcp *self, guint generation, guint t
 		g_mutex_lock(&w->mutex);
 
 		if (w->frame[1] == frame[1] && w->frame[2] == frame[2]) {
+			if (frame[0] == AVC_STATUS_INTERIM)
+				HINAWA_PROBE2(fcp_interim, self, frame);
+			else
+				HINAWA_PROBE3(fcp_final, self, frame, frame_size);
+
 			w->state = WAITER_STATE_RESPONDED;
 			w->generation = generation;
 			w->tstamp = tstamp;
@@ -380,7 +389,6 @@ gboolean hinawa_fw_fcp_avc_transaction_with_tstamp(HinawaFwFcp *self,
 {
 	HinawaFwFcpPrivate *priv;
 	struct waiter w;
-	gulong handler_id;
 	guint generation;
 	gint64 expiration;
 	gboolean result;
@@ -409,20 +417,20 @@ gboolean hinawa_fw_fcp_avc_transaction_with_tstamp(HinawaFwFcp *self,
 	w.frame[2] = cmd[2];
 
 	g_mutex_lock(&w.mutex);
-	handler_id = g_signal_connect(self, "responded", G_CALLBACK(handle_responded_signal),
-				      NULL);
 
 	g_mutex_lock(&priv->transactions_mutex);
 	LIST_INSERT_HEAD(&priv->transactions, &w, list);
 	g_mutex_unlock(&priv->transactions_mutex);
 
 	// Finish transaction for command frame.
-	g_object_get(G_OBJECT(priv->node), "generation", &generation, NULL);
+	hinawa_fw_node_get_bus_state(priv->node, &generation, NULL, NULL, NULL, NULL, NULL, NULL);
 	expiration = g_get_monotonic_time() + timeout_ms * G_TIME_SPAN_MILLISECOND;
 	result = hinawa_fw_fcp_command_with_tstamp(self, cmd, cmd_size, tstamp, timeout_ms, error);
 	if (!result) {
-		g_signal_handler_disconnect(self, handler_id);
 		g_mutex_unlock(&w.mutex);
+		g_mutex_lock(&priv->transactions_mutex);
+		LIST_REMOVE(&w, list);
+		g_mutex_unlock(&priv->transactions_mutex);
 		goto end;
 	}
 deferred:
@@ -442,13 +450,12 @@ deferred:
 		goto deferred;
 	}
 
+	// The waiters are notified with the lock of list held, then the lock of waiter.
+	g_mutex_unlock(&w.mutex);
 	g_mutex_lock(&priv->transactions_mutex);
 	LIST_REMOVE(&w, list);
 	g_mutex_unlock(&priv->transactions_mutex);
 
-	g_signal_handler_disconnect(self, handler_id);
-	g_mutex_unlock(&w.mutex);
-
 	switch (w.state) {
 	case WAITER_STATE_RESPONDED:
 		if (w.generation != generation) {
@@ -612,10 +619,9 @@ static HinawaFwRcode handle_requested_signal(HinawaFwResp *resp, HinawaFwTcode t
 			struct node_record current;
 
 			// NOTE: for the case that the event of bus update is not handled yet.
-			g_object_get(priv->node,
-				     "generation", &current.generation,
-				     "node-id", &current.src_node_id,
-				     NULL);
+			hinawa_fw_node_get_bus_state(priv->node, &current.generation,
+						     &current.src_node_id, NULL, NULL, NULL, NULL,
+						     NULL);
 			if (current.generation != record.generation)
 				node_history_insert_record(&priv->history, &current);
 			recorded = !memcmp(&record, &current, sizeof(record));
@@ -624,8 +630,18 @@ static HinawaFwRcode handle_requested_signal(HinawaFwResp *resp, HinawaFwTcode t
 
 		// Emit the event only when the source node is the target node.
 		if (recorded) {
-			g_signal_emit(self, fw_fcp_sigs[FW_FCP_SIG_TYPE_RESPONDED], 0,
-				      generation, tstamp, frame, length);
+			HinawaFwFcpClass *klass = HINAWA_FW_FCP_GET_CLASS(self);
+
+			notify_waiters(self, generation, tstamp, frame, length);
+
+			if (g_signal_has_handler_pending(self,
+							 fw_fcp_sigs[FW_FCP_SIG_TYPE_RESPONDED], 0,
+							 FALSE)) {
+				g_signal_emit(self, fw_fcp_sigs[FW_FCP_SIG_TYPE_RESPONDED], 0,
+					      generation, tstamp, frame, length);
+			} else if (klass->responded != NULL) {
+				klass->responded(self, generation, tstamp, frame, length);
+			}
 		}
 	}
 
@@ -667,11 +683,8 @@ gboolean hinawa_fw_fcp_bind(HinawaFwFcp *self, HinawaFwNode *node, GError **erro
 		if (!hinawa_fw_resp_reserve(HINAWA_FW_RESP(self), node, FCP_RESPOND_ADDR,
 					    FCP_MAXIMUM_FRAME_BYTES, error))
 			return FALSE;
-		g_object_get(node,
-			     "card-id", &priv->card_id,
-			     "generation", &record.generation,
-			     "node-id", &record.src_node_id,
-			     NULL);
+		hinawa_fw_node_get_bus_state(node, &record.generation, &record.src_node_id, NULL,
+					     NULL, NULL, NULL, &priv->card_id);
 
 		node_history_lock(&priv->history);
 		node_history_reset(&priv->history);
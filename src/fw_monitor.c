@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+
+/**
+ * HinawaFwMonitor:
+ * A monitor of Linux FireWire character devices.
+ *
+ * [class@FwMonitor] enumerates Linux FireWire character devices, and reads identity of node from
+ * sysfs without opening the device. The source retrieved by [method@FwMonitor.create_source]
+ * watches the directory of devices by inotify, then emits [signal@FwMonitor::added] and
+ * [signal@FwMonitor::removed] signals incrementally. The instance of [class@FwNode] added to
+ * the monitor emits [signal@FwNode::disconnected] signal when the device is removed.
+ *
+ * Since: 4.1
+ */
+
+typedef struct {
+	GHashTable *nodes;
+	GMutex mutex;
+} HinawaFwMonitorPrivate;
+G_DEFINE_TYPE_WITH_PRIVATE(HinawaFwMonitor, hinawa_fw_monitor, G_TYPE_OBJECT)
+
+#define DEVICE_DIRECTORY	"/dev"
+#define SYSFS_DIRECTORY		"/sys/bus/firewire/devices"
+
+enum fw_monitor_sig_type {
+	FW_MONITOR_SIG_TYPE_ADDED = 0,
+	FW_MONITOR_SIG_TYPE_REMOVED,
+	FW_MONITOR_SIG_TYPE_COUNT,
+};
+static guint fw_monitor_sigs[FW_MONITOR_SIG_TYPE_COUNT] = { 0 };
+
+typedef struct {
+	GSource src;
+	HinawaFwMonitor *self;
+	int fd;
+	gpointer tag;
+	size_t len;
+	void *buf;
+} FwMonitorSource;
+
+static void fw_monitor_finalize(GObject *obj)
+{
+	HinawaFwMonitor *self = HINAWA_FW_MONITOR(obj);
+	HinawaFwMonitorPrivate *priv = hinawa_fw_monitor_get_instance_private(self);
+
+	g_hash_table_unref(priv->nodes);
+	g_mutex_clear(&priv->mutex);
+
+	G_OBJECT_CLASS(hinawa_fw_monitor_parent_class)->finalize(obj);
+}
+
+static void hinawa_fw_monitor_class_init(HinawaFwMonitorClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->finalize = fw_monitor_finalize;
+
+	/**
+	 * HinawaFwMonitor::added:
+	 * @self: A [class@FwMonitor].
+	 * @path: The path to Linux FireWire character device.
+	 *
+	 * Emitted when the character device is added to the system.
+	 *
+	 * Since: 4.1
+	 */
+	fw_monitor_sigs[FW_MONITOR_SIG_TYPE_ADDED] =
+		g_signal_new("added",
+			     G_OBJECT_CLASS_TYPE(klass),
+			     G_SIGNAL_RUN_LAST,
+			     G_STRUCT_OFFSET(HinawaFwMonitorClass, added),
+			     NULL, NULL,
+			     g_cclosure_marshal_VOID__STRING,
+			     G_TYPE_NONE, 1, G_TYPE_STRING);
+
+	/**
+	 * HinawaFwMonitor::removed:
+	 * @self: A [class@FwMonitor].
+	 * @path: The path to Linux FireWire character device.
+	 *
+	 * Emitted when the character device is removed from the system. The instance of
+	 * [class@FwNode] added to the monitor for the device emits [signal@FwNode::disconnected]
+	 * signal in advance.
+	 *
+	 * Since: 4.1
+	 */
+	fw_monitor_sigs[FW_MONITOR_SIG_TYPE_REMOVED] =
+		g_signal_new("removed",
+			     G_OBJECT_CLASS_TYPE(klass),
+			     G_SIGNAL_RUN_LAST,
+			     G_STRUCT_OFFSET(HinawaFwMonitorClass, removed),
+			     NULL, NULL,
+			     g_cclosure_marshal_VOID__STRING,
+			     G_TYPE_NONE, 1, G_TYPE_STRING);
+}
+
+static void hinawa_fw_monitor_init(HinawaFwMonitor *self)
+{
+	HinawaFwMonitorPrivate *priv = hinawa_fw_monitor_get_instance_private(self);
+
+	priv->nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal, g_object_unref, NULL);
+	g_mutex_init(&priv->mutex);
+}
+
+/**
+ * hinawa_fw_monitor_new:
+ *
+ * Instantiate [class@FwMonitor] object and return the instance.
+ *
+ * Returns: an instance of [class@FwMonitor].
+ * Since: 4.1
+ */
+HinawaFwMonitor *hinawa_fw_monitor_new(void)
+{
+	return g_object_new(HINAWA_TYPE_FW_MONITOR, NULL);
+}
+
+static gint compare_path(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(const gchar *const *)a, *(const gchar *const *)b);
+}
+
+/**
+ * hinawa_fw_monitor_enumerate:
+ * @self: A [class@FwMonitor].
+ * @paths: (out)(transfer full)(array zero-terminated=1): The paths to Linux FireWire character
+ *	   devices in the system.
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@GLib.FileError].
+ *
+ * Enumerate Linux FireWire character devices currently available in the system.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_monitor_enumerate(HinawaFwMonitor *self, gchar ***paths, GError **error)
+{
+	GPtrArray *entries;
+	const gchar *name;
+	GDir *dir;
+
+	g_return_val_if_fail(HINAWA_IS_FW_MONITOR(self), FALSE);
+	g_return_val_if_fail(paths != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	dir = g_dir_open(DEVICE_DIRECTORY, 0, error);
+	if (dir == NULL)
+		return FALSE;
+
+	entries = g_ptr_array_new();
+	while ((name = g_dir_read_name(dir)) != NULL) {
+		if (hinawa_monitor_event_is_device_name(name))
+			g_ptr_array_add(entries, g_build_filename(DEVICE_DIRECTORY, name, NULL));
+	}
+	g_dir_close(dir);
+
+	g_ptr_array_sort(entries, compare_path);
+	g_ptr_array_add(entries, NULL);
+	*paths = (gchar **)g_ptr_array_free(entries, FALSE);
+
+	return TRUE;
+}
+
+static gboolean read_sysfs_attribute(const gchar *name, const gchar *attr, guint64 *value,
+				     GError **error)
+{
+	gchar *path = g_build_filename(SYSFS_DIRECTORY, name, attr, NULL);
+	gchar *contents;
+	gboolean result;
+
+	result = g_file_get_contents(path, &contents, NULL, error);
+	g_free(path);
+	if (!result)
+		return FALSE;
+
+	*value = g_ascii_strtoull(contents, NULL, 16);
+	g_free(contents);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_monitor_read_identity:
+ * @self: A [class@FwMonitor].
+ * @path: The path to Linux FireWire character device.
+ * @guid: (out): The global unique ID of node.
+ * @vendor_id: (out): The vendor ID in root directory of configuration ROM, or zero if absent.
+ * @model_id: (out): The model ID in root directory of configuration ROM, or zero if absent.
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@GLib.FileError].
+ *
+ * Read identity of node for the character device from sysfs, without opening the device.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_monitor_read_identity(HinawaFwMonitor *self, const gchar *path, guint64 *guid,
+					 guint32 *vendor_id, guint32 *model_id, GError **error)
+{
+	gchar *name;
+	guint64 value;
+	gboolean result;
+
+	g_return_val_if_fail(HINAWA_IS_FW_MONITOR(self), FALSE);
+	g_return_val_if_fail(path != NULL && strlen(path) > 0, FALSE);
+	g_return_val_if_fail(guid != NULL, FALSE);
+	g_return_val_if_fail(vendor_id != NULL, FALSE);
+	g_return_val_if_fail(model_id != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	name = g_path_get_basename(path);
+
+	result = read_sysfs_attribute(name, "guid", guid, error);
+	if (result) {
+		// The attributes are absent when the root directory has no corresponding entry.
+		*vendor_id = read_sysfs_attribute(name, "vendor", &value, NULL) ? value : 0;
+		*model_id = read_sysfs_attribute(name, "model", &value, NULL) ? value : 0;
+	}
+
+	g_free(name);
+
+	return result;
+}
+
+/**
+ * hinawa_fw_monitor_add_node:
+ * @self: A [class@FwMonitor].
+ * @node: A [class@FwNode] opened already.
+ *
+ * Add the node so that [signal@FwNode::disconnected] is emitted when the character device for
+ * the node is removed. The monitor keeps the reference of node till the removal.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_monitor_add_node(HinawaFwMonitor *self, HinawaFwNode *node)
+{
+	HinawaFwMonitorPrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_MONITOR(self));
+	g_return_if_fail(HINAWA_IS_FW_NODE(node));
+	g_return_if_fail(hinawa_fw_node_get_path(node) != NULL);
+
+	priv = hinawa_fw_monitor_get_instance_private(self);
+
+	g_mutex_lock(&priv->mutex);
+	if (!g_hash_table_contains(priv->nodes, node))
+		g_hash_table_add(priv->nodes, g_object_ref(node));
+	g_mutex_unlock(&priv->mutex);
+}
+
+/**
+ * hinawa_fw_monitor_remove_node:
+ * @self: A [class@FwMonitor].
+ * @node: A [class@FwNode].
+ *
+ * Remove the node added by [method@FwMonitor.add_node].
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_monitor_remove_node(HinawaFwMonitor *self, HinawaFwNode *node)
+{
+	HinawaFwMonitorPrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_MONITOR(self));
+	g_return_if_fail(HINAWA_IS_FW_NODE(node));
+
+	priv = hinawa_fw_monitor_get_instance_private(self);
+
+	g_mutex_lock(&priv->mutex);
+	g_hash_table_remove(priv->nodes, node);
+	g_mutex_unlock(&priv->mutex);
+}
+
+static void handle_removal(HinawaFwMonitor *self, const gchar *path)
+{
+	HinawaFwMonitorPrivate *priv = hinawa_fw_monitor_get_instance_private(self);
+	GHashTableIter iter;
+	gpointer key;
+	GList *nodes = NULL;
+	GList *entry;
+
+	g_mutex_lock(&priv->mutex);
+	g_hash_table_iter_init(&iter, priv->nodes);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		if (!g_strcmp0(hinawa_fw_node_get_path(key), path)) {
+			nodes = g_list_prepend(nodes, key);
+			g_hash_table_iter_steal(&iter);
+		}
+	}
+	g_mutex_unlock(&priv->mutex);
+
+	for (entry = nodes; entry != NULL; entry = entry->next) {
+		hinawa_fw_node_handle_disconnection(entry->data);
+		g_object_unref(entry->data);
+	}
+	g_list_free(nodes);
+
+	g_signal_emit(self, fw_monitor_sigs[FW_MONITOR_SIG_TYPE_REMOVED], 0, path);
+}
+
+static void handle_event(const gchar *name, gboolean added, gpointer user_data)
+{
+	HinawaFwMonitor *self = user_data;
+	gchar *path = g_build_filename(DEVICE_DIRECTORY, name, NULL);
+
+	if (added)
+		g_signal_emit(self, fw_monitor_sigs[FW_MONITOR_SIG_TYPE_ADDED], 0, path);
+	else
+		handle_removal(self, path);
+
+	g_free(path);
+}
+
+static gboolean check_src(GSource *gsrc)
+{
+	FwMonitorSource *src = (FwMonitorSource *)gsrc;
+	GIOCondition condition;
+
+	condition = g_source_query_unix_fd(gsrc, src->tag);
+	return !!(condition & (G_IO_IN | G_IO_ERR));
+}
+
+static gboolean dispatch_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+{
+	FwMonitorSource *src = (FwMonitorSource *)gsrc;
+	GIOCondition condition;
+	ssize_t len;
+
+	condition = g_source_query_unix_fd(gsrc, src->tag);
+	if (condition & G_IO_ERR)
+		return G_SOURCE_REMOVE;
+
+	// The file descriptor is non-blocking.
+	while ((len = read(src->fd, src->buf, src->len)) > 0)
+		hinawa_monitor_event_parse(src->buf, len, handle_event, src->self);
+
+	if (len < 0 && errno != EAGAIN && errno != EINTR)
+		return G_SOURCE_REMOVE;
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void finalize_src(GSource *gsrc)
+{
+	FwMonitorSource *src = (FwMonitorSource *)gsrc;
+
+	close(src->fd);
+	g_free(src->buf);
+	g_object_unref(src->self);
+}
+
+/**
+ * hinawa_fw_monitor_create_source:
+ * @self: A [class@FwMonitor].
+ * @gsrc: (out): A [struct@GLib.Source].
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
+ *
+ * Create [struct@GLib.Source] for [struct@GLib.MainContext] to watch addition and removal of
+ * Linux FireWire character devices.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_monitor_create_source(HinawaFwMonitor *self, GSource **gsrc, GError **error)
+{
+	static GSourceFuncs funcs = {
+		.check		= check_src,
+		.dispatch	= dispatch_src,
+		.finalize	= finalize_src,
+	};
+	FwMonitorSource *src;
+	int fd;
+
+	g_return_val_if_fail(HINAWA_IS_FW_MONITOR(self), FALSE);
+	g_return_val_if_fail(gsrc != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		generate_syscall_error(error, errno, "inotify_init1(%s)", "IN_NONBLOCK | IN_CLOEXEC");
+		return FALSE;
+	}
+
+	if (inotify_add_watch(fd, DEVICE_DIRECTORY, IN_CREATE | IN_DELETE) < 0) {
+		generate_syscall_error(error, errno, "inotify_add_watch(%s)", DEVICE_DIRECTORY);
+		close(fd);
+		return FALSE;
+	}
+
+	*gsrc = g_source_new(&funcs, sizeof(FwMonitorSource));
+	src = (FwMonitorSource *)(*gsrc);
+
+	g_source_set_name(*gsrc, "HinawaFwMonitor");
+
+	// Enough for several events with the longest name.
+	src->len = 16 * (sizeof(struct inotify_event) + NAME_MAX + 1);
+	src->buf = g_malloc0(src->len);
+
+	src->self = g_object_ref(self);
+	src->fd = fd;
+	src->tag = g_source_add_unix_fd(*gsrc, fd, G_IO_IN);
+
+	return TRUE;
+}
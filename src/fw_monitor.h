@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#ifndef __ORG_KERNEL_HINAWA_FW_MONITOR_H__
+#define __ORG_KERNEL_HINAWA_FW_MONITOR_H__
+
+#include <hinawa.h>
+
+G_BEGIN_DECLS
+
+#define HINAWA_TYPE_FW_MONITOR	(hinawa_fw_monitor_get_type())
+
+G_DECLARE_DERIVABLE_TYPE(HinawaFwMonitor, hinawa_fw_monitor, HINAWA, FW_MONITOR, GObject)
+
+struct _HinawaFwMonitorClass {
+	GObjectClass parent_class;
+
+	/**
+	 * HinawaFwMonitorClass::added:
+	 * @self: A [class@FwMonitor].
+	 * @path: The path to Linux FireWire character device.
+	 *
+	 * Class closure for the [signal@FwMonitor::added].
+	 *
+	 * Since: 4.1
+	 */
+	void (*added)(HinawaFwMonitor *self, const gchar *path);
+
+	/**
+	 * HinawaFwMonitorClass::removed:
+	 * @self: A [class@FwMonitor].
+	 * @path: The path to Linux FireWire character device.
+	 *
+	 * Class closure for the [signal@FwMonitor::removed].
+	 *
+	 * Since: 4.1
+	 */
+	void (*removed)(HinawaFwMonitor *self, const gchar *path);
+};
+
+HinawaFwMonitor *hinawa_fw_monitor_new(void);
+
+gboolean hinawa_fw_monitor_enumerate(HinawaFwMonitor *self, gchar ***paths, GError **error);
+
+gboolean hinawa_fw_monitor_read_identity(HinawaFwMonitor *self, const gchar *path, guint64 *guid,
+					 guint32 *vendor_id, guint32 *model_id, GError **error);
+
+void hinawa_fw_monitor_add_node(HinawaFwMonitor *self, HinawaFwNode *node);
+
+void hinawa_fw_monitor_remove_node(HinawaFwMonitor *self, HinawaFwNode *node);
+
+gboolean hinawa_fw_monitor_create_source(HinawaFwMonitor *self, GSource **gsrc, GError **error);
+
+G_END_DECLS
+
+#endif
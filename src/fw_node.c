@@ -1,13 +1,23 @@
 // SPDX-License-Identifier: LGPL-2.1-or-later
+// For CPU_SET() and pthread_setaffinity_np().
+#define _GNU_SOURCE
 #include "internal.h"
 
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <errno.h>
 
+#ifdef HAVE_IO_URING
+#include <liburing.h>
+#endif
+
 /**
  * HinawaFwNode:
  * An event listener for node in IEEE 1394 bus.
@@ -24,17 +34,90 @@
 #define MAX_CONFIG_ROM_SIZE	256
 #define MAX_CONFIG_ROM_LENGTH	(MAX_CONFIG_ROM_SIZE * 4)
 
+// The number of buffers cached in the pool to read events.
+#define MAX_CACHED_BUFFERS	32
+
+struct dispatcher;
+
+// The slot of trace ring. The sequence is odd while the writer updates it.
+struct trace_slot {
+	gint seq;
+	guint index;
+	HinawaFwNodeTraceEntry entry;
+};
+
+// The snapshot of bus state at current generation. It is published by sequence lock so that
+// readers in hot paths can retrieve it without acquiring the mutex.
+struct bus_state {
+	gint seq;
+	gint generation;
+	gint node_id;
+	gint local_node_id;
+	gint bm_node_id;
+	gint irm_node_id;
+	gint root_node_id;
+	gint card_id;
+};
+
+// The counters are updated with relaxed ordering since they are independent each other and
+// just for statistics.
+#define stats_add(field, val)	__atomic_fetch_add(&(field), (val), __ATOMIC_RELAXED)
+#define stats_get(field)	__atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+// The parameters of dispatch are accessed without the lock as well.
+#define param_get(field)	__atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define param_set(field, val)	__atomic_store_n(&(field), (val), __ATOMIC_RELAXED)
+
 typedef struct {
 	int fd;
+	const struct hinawa_fw_node_backend *backend;
+	gpointer backend_data;
+	gchar *path;
+	gchar *record_path;
+	gint disconnected;
+	guint64 closure;
 
 	GMutex mutex;
-	guint8 config_rom[MAX_CONFIG_ROM_LENGTH];
-	gsize config_rom_length;
+	GBytes *config_rom;
+	HinawaConfigRom *config_rom_index;
+	GPtrArray *retired_config_roms;
+	gboolean config_rom_exposed;
+	guint32 cached_rom[MAX_CONFIG_ROM_SIZE];
+	gsize cached_rom_length;
 	struct fw_cdev_event_bus_reset generation;
 	guint32 card_id;
+	struct bus_state bus_state;
 
-	GList *transactions;
+	GHashTable *transactions;
 	GMutex transactions_mutex;
+
+	// Accessed atomically.
+	guint dispatch_event_budget;
+	guint dispatch_time_budget;
+	guint64 dispatch_wakeups;
+	guint64 dispatched_events;
+	guint64 dispatch_syscalls;
+	gboolean io_uring;
+	gboolean prioritize_bus_reset;
+
+	struct trace_slot *trace;
+	guint trace_size;
+	gint trace_head;
+
+	HinawaFwNodeStats stats;
+
+	GPtrArray *filters;
+	GMutex filters_mutex;
+	// The length of list, read without the lock in the path to handle event.
+	gint filter_count;
+
+	struct hinawa_buffer_pool *pool;
+
+	// The function called without emission of signal. It is called without the lock.
+	GMutex callback_mutex;
+	struct hinawa_callback *bus_update_cb;
+
+	struct dispatcher *dispatcher;
 } HinawaFwNodePrivate;
 G_DEFINE_TYPE_WITH_PRIVATE(HinawaFwNode, hinawa_fw_node, G_TYPE_OBJECT)
 
@@ -61,18 +144,26 @@ static const char *const err_msgs[] = {
 #define generate_file_error(error, code, format, arg) \
 	g_set_error(error, G_FILE_ERROR, code, format, arg)
 
-#define generate_syscall_error(error, errno, format, arg)				\
-	g_set_error(error, HINAWA_FW_NODE_ERROR, HINAWA_FW_NODE_ERROR_FAILED,	\
-		    format " %d(%s)", arg, errno, strerror(errno))
-
 typedef struct {
 	GSource src;
 	HinawaFwNode *self;
 	gpointer tag;
-	size_t len;
+#ifdef HAVE_IO_URING
 	void *buf;
+	struct io_uring ring;
+	gboolean ring_ready;
+	gboolean pending;
+#endif
 } FwNodeSource;
 
+// The source to dispatch the class of events forwarded from the source to read them.
+typedef struct {
+	GSource src;
+	GWeakRef self;
+	HinawaFwNodeEventClass classes;
+	GAsyncQueue *queue;
+} FwNodeFilteredSource;
+
 enum fw_node_prop_type {
 	FW_NODE_PROP_TYPE_NODE_ID = 1,
 	FW_NODE_PROP_TYPE_LOCAL_NODE_ID,
@@ -81,27 +172,74 @@ enum fw_node_prop_type {
 	FW_NODE_PROP_TYPE_ROOT_NODE_ID,
 	FW_NODE_PROP_TYPE_GENERATION,
 	FW_NODE_PROP_TYPE_CARD_ID,
+	FW_NODE_PROP_TYPE_DISPATCH_EVENT_BUDGET,
+	FW_NODE_PROP_TYPE_DISPATCH_TIME_BUDGET,
+	FW_NODE_PROP_TYPE_DISPATCH_WAKEUPS,
+	FW_NODE_PROP_TYPE_DISPATCHED_EVENTS,
+	FW_NODE_PROP_TYPE_DISPATCH_SYSCALLS,
+	FW_NODE_PROP_TYPE_IO_URING,
+	FW_NODE_PROP_TYPE_TRACE_SIZE,
+	FW_NODE_PROP_TYPE_PRIORITIZE_BUS_RESET,
+	FW_NODE_PROP_TYPE_RECORD_PATH,
 	FW_NODE_PROP_TYPE_COUNT,
 };
 static GParamSpec *fw_node_props[FW_NODE_PROP_TYPE_COUNT] = { NULL, };
 
-// This object has two signals.
+// This object has three signals.
 enum fw_node_sig_type {
 	FW_NODE_SIG_TYPE_BUS_UPDATE = 0,
 	FW_NODE_SIG_TYPE_DISCONNECTED,
+	FW_NODE_SIG_TYPE_CONFIG_ROM_CHANGED,
 	FW_NODE_SIG_TYPE_COUNT,
 };
 static guint fw_node_sigs[FW_NODE_SIG_TYPE_COUNT] = { 0 };
 
+static void fw_node_dispose(GObject *obj)
+{
+	HinawaFwNode *self = HINAWA_FW_NODE(obj);
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+
+	if (priv->closure > 0) {
+		hinawa_closure_unregister(priv->closure);
+		priv->closure = 0;
+	}
+
+	G_OBJECT_CLASS(hinawa_fw_node_parent_class)->dispose(obj);
+}
+
 static void fw_node_finalize(GObject *obj)
 {
 	HinawaFwNode *self = HINAWA_FW_NODE(obj);
 	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
 
+	hinawa_fw_node_terminate_dispatcher(self);
+
 	if (priv->fd >= 0)
-		close(priv->fd);
+		priv->backend->close(priv->fd, priv->backend_data);
+
+	g_hash_table_unref(priv->transactions);
+	g_free(priv->path);
+	g_free(priv->record_path);
+
+	// The source can not dispatch events anymore.
+	g_ptr_array_foreach(priv->filters, (GFunc)g_source_destroy, NULL);
+	g_ptr_array_unref(priv->filters);
+	g_mutex_clear(&priv->filters_mutex);
+
+	if (priv->config_rom_index != NULL)
+		hinawa_config_rom_unref(priv->config_rom_index);
+	if (priv->config_rom != NULL)
+		g_bytes_unref(priv->config_rom);
+	g_ptr_array_unref(priv->retired_config_roms);
 
-	g_list_free(priv->transactions);
+	g_free(priv->trace);
+
+	// The buffers kept by users still refer to the pool.
+	hinawa_buffer_pool_unref(priv->pool);
+
+	if (priv->bus_update_cb != NULL)
+		hinawa_callback_unref(priv->bus_update_cb);
+	g_mutex_clear(&priv->callback_mutex);
 
 	G_OBJECT_CLASS(hinawa_fw_node_parent_class)->finalize(obj);
 }
@@ -111,31 +249,124 @@ static void fw_node_get_property(GObject *obj, guint id,
 {
 	HinawaFwNode *self = HINAWA_FW_NODE(obj);
 	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	guint generation, node_id, local_node_id, bm_node_id, irm_node_id, root_node_id, card_id;
 
-	g_mutex_lock(&priv->mutex);
+	// The state of bus is retrieved from the snapshot without the mutex.
+	hinawa_fw_node_get_bus_state(self, &generation, &node_id, &local_node_id, &bm_node_id,
+				     &irm_node_id, &root_node_id, &card_id);
 
 	switch (id) {
 	case FW_NODE_PROP_TYPE_NODE_ID:
-		g_value_set_uint(val, priv->generation.node_id);
-		break;
+		g_value_set_uint(val, node_id);
+		return;
 	case FW_NODE_PROP_TYPE_LOCAL_NODE_ID:
-		g_value_set_uint(val, priv->generation.local_node_id);
-		break;
+		g_value_set_uint(val, local_node_id);
+		return;
 	case FW_NODE_PROP_TYPE_BUS_MANAGER_NODE_ID:
-		g_value_set_uint(val, priv->generation.bm_node_id);
-		break;
+		g_value_set_uint(val, bm_node_id);
+		return;
 	case FW_NODE_PROP_TYPE_IR_MANAGER_NODE_ID:
-		g_value_set_uint(val, priv->generation.irm_node_id);
-		break;
+		g_value_set_uint(val, irm_node_id);
+		return;
 	case FW_NODE_PROP_TYPE_ROOT_NODE_ID:
-		g_value_set_uint(val, priv->generation.root_node_id);
-		break;
+		g_value_set_uint(val, root_node_id);
+		return;
 	case FW_NODE_PROP_TYPE_GENERATION:
-		g_value_set_uint(val, priv->generation.generation);
-		break;
+		g_value_set_uint(val, generation);
+		return;
 	case FW_NODE_PROP_TYPE_CARD_ID:
-		g_value_set_uint(val, priv->card_id);
+		g_value_set_uint(val, card_id);
+		return;
+	default:
+		break;
+	}
+
+	// The parameters and the counters for dispatch are accessed atomically without the lock.
+	switch (id) {
+	case FW_NODE_PROP_TYPE_DISPATCH_EVENT_BUDGET:
+		g_value_set_uint(val, param_get(priv->dispatch_event_budget));
+		return;
+	case FW_NODE_PROP_TYPE_DISPATCH_TIME_BUDGET:
+		g_value_set_uint(val, param_get(priv->dispatch_time_budget));
+		return;
+	case FW_NODE_PROP_TYPE_DISPATCH_WAKEUPS:
+		g_value_set_uint64(val, stats_get(priv->dispatch_wakeups));
+		return;
+	case FW_NODE_PROP_TYPE_DISPATCHED_EVENTS:
+		g_value_set_uint64(val, stats_get(priv->dispatched_events));
+		return;
+	case FW_NODE_PROP_TYPE_DISPATCH_SYSCALLS:
+		g_value_set_uint64(val, stats_get(priv->dispatch_syscalls));
+		return;
+	case FW_NODE_PROP_TYPE_PRIORITIZE_BUS_RESET:
+		g_value_set_boolean(val, param_get(priv->prioritize_bus_reset));
+		return;
+	default:
+		break;
+	}
+
+	g_mutex_lock(&priv->mutex);
+
+	switch (id) {
+	case FW_NODE_PROP_TYPE_IO_URING:
+		g_value_set_boolean(val, priv->io_uring);
+		break;
+	case FW_NODE_PROP_TYPE_TRACE_SIZE:
+		g_value_set_uint(val, priv->trace_size);
+		break;
+	case FW_NODE_PROP_TYPE_RECORD_PATH:
+		g_value_set_string(val, priv->record_path);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, id, spec);
+		break;
+	}
+
+	g_mutex_unlock(&priv->mutex);
+}
+
+static void fw_node_set_property(GObject *obj, guint id, const GValue *val, GParamSpec *spec)
+{
+	HinawaFwNode *self = HINAWA_FW_NODE(obj);
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+
+	switch (id) {
+	case FW_NODE_PROP_TYPE_DISPATCH_EVENT_BUDGET:
+		param_set(priv->dispatch_event_budget, g_value_get_uint(val));
+		return;
+	case FW_NODE_PROP_TYPE_DISPATCH_TIME_BUDGET:
+		param_set(priv->dispatch_time_budget, g_value_get_uint(val));
+		return;
+	case FW_NODE_PROP_TYPE_PRIORITIZE_BUS_RESET:
+		param_set(priv->prioritize_bus_reset, g_value_get_boolean(val));
+		return;
+	default:
+		break;
+	}
+
+	g_mutex_lock(&priv->mutex);
+
+	switch (id) {
+	case FW_NODE_PROP_TYPE_IO_URING:
+		priv->io_uring = g_value_get_boolean(val);
 		break;
+	case FW_NODE_PROP_TYPE_RECORD_PATH:
+		g_free(priv->record_path);
+		priv->record_path = g_value_dup_string(val);
+		break;
+	case FW_NODE_PROP_TYPE_TRACE_SIZE:
+	{
+		guint size = g_value_get_uint(val);
+
+		// Construct-only. The size is rounded up to power of two for the mask of index.
+		if (size > 0) {
+			priv->trace_size = 1;
+			while (priv->trace_size < size)
+				priv->trace_size <<= 1;
+			priv->trace = g_new0(struct trace_slot, priv->trace_size);
+		}
+		break;
+	}
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, id, spec);
 		break;
@@ -148,8 +379,10 @@ static void hinawa_fw_node_class_init(HinawaFwNodeClass *klass)
 {
 	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
 
+	gobject_class->dispose = fw_node_dispose;
 	gobject_class->finalize = fw_node_finalize;
 	gobject_class->get_property = fw_node_get_property;
+	gobject_class->set_property = fw_node_set_property;
 
 	/**
 	 * HinawaFwNode:node-id:
@@ -254,6 +487,157 @@ static void hinawa_fw_node_class_init(HinawaFwNodeClass *klass)
 				  0, G_MAXUINT32, 0,
 				  G_PARAM_READABLE);
 
+	/**
+	 * HinawaFwNode:dispatch-event-budget:
+	 *
+	 * The maximum number of events processed in a single dispatch of the source retrieved by
+	 * [method@FwNode.create_source]. The default value is 1, thus the source processes one
+	 * event per iteration of [struct@GLib.MainContext]. When the value is 0, the source
+	 * processes queued events till no event is available.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_DISPATCH_EVENT_BUDGET] =
+		g_param_spec_uint("dispatch-event-budget", "dispatch-event-budget",
+				  "The maximum number of events processed in a single dispatch of "
+				  "the source",
+				  0, G_MAXUINT, 1,
+				  G_PARAM_READWRITE);
+
+	/**
+	 * HinawaFwNode:dispatch-time-budget:
+	 *
+	 * The maximum time in microseconds spent to process queued events in a single dispatch of
+	 * the source retrieved by [method@FwNode.create_source]. The value is checked after
+	 * processing each event. When the value is 0, the time is not limited.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_DISPATCH_TIME_BUDGET] =
+		g_param_spec_uint("dispatch-time-budget", "dispatch-time-budget",
+				  "The maximum time in microseconds spent to process queued events "
+				  "in a single dispatch of the source",
+				  0, G_MAXUINT, 0,
+				  G_PARAM_READWRITE);
+
+	/**
+	 * HinawaFwNode:dispatch-wakeups:
+	 *
+	 * The number of dispatches of the source to process events. The ratio between
+	 * [property@FwNode:dispatched-events] and the value is the average number of events
+	 * processed per wakeup.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_DISPATCH_WAKEUPS] =
+		g_param_spec_uint64("dispatch-wakeups", "dispatch-wakeups",
+				    "The number of dispatches of the source to process events",
+				    0, G_MAXUINT64, 0,
+				    G_PARAM_READABLE);
+
+	/**
+	 * HinawaFwNode:dispatched-events:
+	 *
+	 * The number of events processed by the source.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_DISPATCHED_EVENTS] =
+		g_param_spec_uint64("dispatched-events", "dispatched-events",
+				    "The number of events processed by the source",
+				    0, G_MAXUINT64, 0,
+				    G_PARAM_READABLE);
+
+	/**
+	 * HinawaFwNode:dispatch-syscalls:
+	 *
+	 * The number of system calls issued by the source to process events, except for the poll
+	 * by [struct@GLib.MainContext].
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_DISPATCH_SYSCALLS] =
+		g_param_spec_uint64("dispatch-syscalls", "dispatch-syscalls",
+				    "The number of system calls issued by the source to process "
+				    "events",
+				    0, G_MAXUINT64, 0,
+				    G_PARAM_READABLE);
+
+	/**
+	 * HinawaFwNode:io-uring:
+	 *
+	 * Whether to read events by io_uring in the source retrieved by
+	 * [method@FwNode.create_source]. When the library is built without support of io_uring,
+	 * or the running kernel does not support it, the source falls back to `read(2)`. The
+	 * source falls back as well when the file descriptor is not for character device, such
+	 * as the one emulated by the preloaded shim.
+	 *
+	 * Linux FireWire subsystem does not support non-blocking I/O for the character device,
+	 * thus io_uring completes the read in its worker. The source keeps one read in flight
+	 * to preserve the order of events, and the budget of dispatch is not applied.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_IO_URING] =
+		g_param_spec_boolean("io-uring", "io-uring",
+				     "Whether to read events by io_uring in the source",
+				     FALSE,
+				     G_PARAM_READWRITE);
+
+	/**
+	 * HinawaFwNode:trace-size:
+	 *
+	 * The number of entries in the ring to trace events read by the node, rounded up to power
+	 * of two. Zero disables the trace. The ring is written without any lock in the path of
+	 * dispatch, and the latest entries are retrieved by [method@FwNode.dump_trace].
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_TRACE_SIZE] =
+		g_param_spec_uint("trace-size", "trace-size",
+				  "The number of entries in the ring to trace events",
+				  0, G_MAXUINT16,
+				  0,
+				  G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	/**
+	 * HinawaFwNode:prioritize-bus-reset:
+	 *
+	 * Whether to handle the event of bus reset ahead of the other events read in a single
+	 * dispatch of the source retrieved by [method@FwNode.create_source]. The source reads the
+	 * queued events within [property@FwNode:dispatch-event-budget] at first, then handles the
+	 * latest event of bus reset in them. The earlier events of bus reset are superseded by it.
+	 * The responses queued before the event of bus reset are handled ahead of it, since the
+	 * transactions are finished at the former generation. The request from the node at the
+	 * stale generation is rejected by [enum@FwRcode].CONFLICT_ERROR without emitting
+	 * [signal@FwResp::requested]. It is not applied to the source reading events by io_uring.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_PRIORITIZE_BUS_RESET] =
+		g_param_spec_boolean("prioritize-bus-reset", "prioritize-bus-reset",
+				     "Whether to handle the event of bus reset ahead of the other "
+				     "events in a single dispatch",
+				     FALSE,
+				     G_PARAM_READWRITE);
+
+	/**
+	 * HinawaFwNode:record-path:
+	 *
+	 * The path to file to record the events read from the node and the ioctls issued to it
+	 * after [method@FwNode.open]. The property is checked when opening the node. The file is
+	 * append-only and can be replayed by the path with `replay:` or `replay-fast:` prefix for
+	 * [method@FwNode.open]. The source reading events by io_uring is not available during
+	 * the record.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_props[FW_NODE_PROP_TYPE_RECORD_PATH] =
+		g_param_spec_string("record-path", "record-path",
+				    "The path to file to record the events and the ioctls",
+				    NULL,
+				    G_PARAM_READWRITE);
+
 	g_object_class_install_properties(gobject_class,
 					  FW_NODE_PROP_TYPE_COUNT,
 					  fw_node_props);
@@ -265,6 +649,9 @@ static void hinawa_fw_node_class_init(HinawaFwNodeClass *klass)
 	 * Emitted when IEEE 1394 bus is updated. Handlers can read current generation in the bus
 	 * via [property@FwNode:generation] property.
 	 *
+	 * The signal is not emitted when the function is set by
+	 * [method@FwNode.set_bus_update_func] and no handler is connected.
+	 *
 	 * Since: 1.4
 	 */
 	fw_node_sigs[FW_NODE_SIG_TYPE_BUS_UPDATE] =
@@ -283,6 +670,9 @@ static void hinawa_fw_node_class_init(HinawaFwNodeClass *klass)
 	 * Emitted when the node is not available anymore in Linux system. It's preferable to call
 	 * [method@GObject.Object.unref] immediately to release file descriptor.
 	 *
+	 * The signal is emitted just once, even when the removal of character device is also
+	 * detected by [class@FwMonitor] which the node is added to.
+	 *
 	 * Since: 1.4
 	 */
 	fw_node_sigs[FW_NODE_SIG_TYPE_DISCONNECTED] =
@@ -293,6 +683,25 @@ static void hinawa_fw_node_class_init(HinawaFwNodeClass *klass)
 			     NULL, NULL,
 			     g_cclosure_marshal_VOID__VOID,
 			     G_TYPE_NONE, 0, G_TYPE_NONE);
+
+	/**
+	 * HinawaFwNode::config-rom-changed:
+	 * @self: A [class@FwNode].
+	 *
+	 * Emitted when the content of configuration ROM is changed by bus reset. It is emitted
+	 * before [signal@FwNode::bus-update]. Handlers can invalidate the data parsed from the
+	 * content of configuration ROM.
+	 *
+	 * Since: 4.1
+	 */
+	fw_node_sigs[FW_NODE_SIG_TYPE_CONFIG_ROM_CHANGED] =
+		g_signal_new("config-rom-changed",
+			     G_OBJECT_CLASS_TYPE(klass),
+			     G_SIGNAL_RUN_LAST,
+			     0,
+			     NULL, NULL,
+			     g_cclosure_marshal_VOID__VOID,
+			     G_TYPE_NONE, 0, G_TYPE_NONE);
 }
 
 static void hinawa_fw_node_init(HinawaFwNode *self)
@@ -300,8 +709,20 @@ static void hinawa_fw_node_init(HinawaFwNode *self)
 	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
 
 	priv->fd = -1;
+	priv->closure = hinawa_closure_register(HINAWA_CLOSURE_KIND_FW_NODE, self);
+	priv->retired_config_roms = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	priv->dispatch_event_budget = 1;
 	g_mutex_init(&priv->mutex);
+	priv->transactions = g_hash_table_new_full(g_direct_hash, g_direct_equal, g_object_unref,
+						   NULL);
 	g_mutex_init(&priv->transactions_mutex);
+	priv->filters = g_ptr_array_new_with_free_func((GDestroyNotify)g_source_unref);
+	g_mutex_init(&priv->filters_mutex);
+
+	// MEMO: one page for each buffer because we cannot assume the size of transaction frame.
+	priv->pool = hinawa_buffer_pool_new(sysconf(_SC_PAGESIZE), MAX_CACHED_BUFFERS);
+
+	g_mutex_init(&priv->callback_mutex);
 }
 
 /**
@@ -317,11 +738,32 @@ HinawaFwNode *hinawa_fw_node_new(void)
 	return g_object_new(HINAWA_TYPE_FW_NODE, NULL);
 }
 
-static int update_info(HinawaFwNode *self)
+// The caller should acquire the mutex so that writers are serialized.
+static void publish_bus_state(HinawaFwNodePrivate *priv)
+{
+	struct bus_state *state = &priv->bus_state;
+
+	// The odd value of sequence expresses that the update is in progress.
+	g_atomic_int_inc(&state->seq);
+
+	g_atomic_int_set(&state->generation, priv->generation.generation);
+	g_atomic_int_set(&state->node_id, priv->generation.node_id);
+	g_atomic_int_set(&state->local_node_id, priv->generation.local_node_id);
+	g_atomic_int_set(&state->bm_node_id, priv->generation.bm_node_id);
+	g_atomic_int_set(&state->irm_node_id, priv->generation.irm_node_id);
+	g_atomic_int_set(&state->root_node_id, priv->generation.root_node_id);
+	g_atomic_int_set(&state->card_id, priv->card_id);
+
+	g_atomic_int_inc(&state->seq);
+}
+
+static int update_info(HinawaFwNode *self, gboolean *rom_changed)
 {
 	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
 	struct fw_cdev_get_info info = {0};
+	guint32 raw[MAX_CONFIG_ROM_SIZE];
 	guint32 *rom;
+	GBytes *snapshot;
 	unsigned int quads;
 	int i;
 
@@ -331,21 +773,47 @@ static int update_info(HinawaFwNode *self)
 	//    - struct fw_cdev_event_request3
 	//    - struct fw_cdev_event_response2
 	info.version = 6;
-	info.rom = (__u64)priv->config_rom;
+	info.rom = (__u64)raw;
 	info.rom_length = MAX_CONFIG_ROM_LENGTH;
 	info.bus_reset = (__u64)&priv->generation;
-	info.bus_reset_closure = (__u64)self;
-	if (ioctl(priv->fd, FW_CDEV_IOC_GET_INFO, &info) < 0)
+	info.bus_reset_closure = priv->closure;
+	if (priv->backend->ioctl(priv->fd, FW_CDEV_IOC_GET_INFO, &info, priv->backend_data) < 0)
 		return errno;
 
+	priv->card_id = info.card;
+
+	publish_bus_state(priv);
+
+	// The content of configuration ROM is rarely changed by bus reset. Keep the previous
+	// content as is unless it differs from the cache.
+	quads = (MIN(info.rom_length, MAX_CONFIG_ROM_LENGTH) + 3) / 4;
+	*rom_changed = priv->config_rom == NULL || info.rom_length != priv->cached_rom_length ||
+		       memcmp(raw, priv->cached_rom, quads * 4) != 0;
+	if (!*rom_changed)
+		return 0;
+
+	memcpy(priv->cached_rom, raw, quads * 4);
+	priv->cached_rom_length = info.rom_length;
+
 	// Linux FireWire subsystem caches the content of configuration ROM by host-endian.
-	rom = (guint32 *)priv->config_rom;
-	quads = (info.rom_length + 3) / 4;
+	rom = g_malloc(quads * 4);
 	for (i = 0; i < quads; ++i)
-		rom[i] = GUINT32_TO_BE(rom[i]);
-	priv->config_rom_length = info.rom_length;
+		rom[i] = GUINT32_TO_BE(raw[i]);
+	snapshot = g_bytes_new_take(rom, MIN(info.rom_length, MAX_CONFIG_ROM_LENGTH));
+
+	// The snapshot is immutable. The previous one is kept when the pointer to its content has
+	// been returned by hinawa_fw_node_get_config_rom(), since the caller has no reference.
+	if (priv->config_rom != NULL) {
+		if (priv->config_rom_exposed)
+			g_ptr_array_add(priv->retired_config_roms, priv->config_rom);
+		else
+			g_bytes_unref(priv->config_rom);
+	}
+	priv->config_rom = snapshot;
+	priv->config_rom_exposed = FALSE;
 
-	priv->card_id = info.card;
+	// The index is built again at next access.
+	g_clear_pointer(&priv->config_rom_index, hinawa_config_rom_unref);
 
 	return 0;
 }
@@ -360,6 +828,22 @@ static int update_info(HinawaFwNode *self)
  *
  * Open Linux FireWire character device to operate node in IEEE 1394 bus.
  *
+ * When @path is `sim` or starts with `sim:`, the instance operates a node in the bus simulated
+ * in the process instead of the character device. The options after the colon are separated by
+ * comma; `latency=N` for the latency in microseconds to deliver events, `busy=N` to respond
+ * with [enum@FwRcode].BUSY to every N-th request, `reset=N` to generate bus reset every N
+ * milliseconds, and `fcp` or `fcp=interim` to respond to AV/C command. In the simulated bus,
+ * the request to the range of address reserved by [class@FwResp] is delivered to it, and the
+ * request to the other address is handled by the node with 64 KiB memory addressed by the
+ * lower bits of address. It is useful to measure and test the transactions without hardware.
+ * (Since: 4.1)
+ *
+ * When @path starts with `replay:` followed by the path to the file recorded by
+ * [property@FwNode:record-path], the instance replays the events in the file with the original
+ * timing. The `replay-fast:` prefix replays them as fast as possible. The event in the record
+ * is delivered after the preceding ioctl in the record is issued again, so that the closures
+ * in the events are associated to the instances in the current process. (Since: 4.1)
+ *
  * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
  *
  * Since: 4.0
@@ -367,6 +851,7 @@ static int update_info(HinawaFwNode *self)
 gboolean hinawa_fw_node_open(HinawaFwNode *self, const gchar *path, gint open_flag, GError **error)
 {
 	HinawaFwNodePrivate *priv;
+	gboolean rom_changed;
 	int err;
 
 	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
@@ -380,7 +865,16 @@ gboolean hinawa_fw_node_open(HinawaFwNode *self, const gchar *path, gint open_fl
 	}
 
 	open_flag |= O_RDONLY;
-	priv->fd = open(path, open_flag);
+	priv->backend = hinawa_fw_node_backend_lookup(path);
+	g_mutex_lock(&priv->mutex);
+	if (priv->record_path != NULL) {
+		priv->fd = hinawa_fw_node_recorder_open(priv->backend, path, priv->record_path,
+							open_flag, &priv->backend_data);
+		priv->backend = &hinawa_fw_node_recorder_backend;
+	} else {
+		priv->fd = priv->backend->open(path, open_flag, &priv->backend_data);
+	}
+	g_mutex_unlock(&priv->mutex);
 	if (priv->fd < 0) {
 		if (errno == ENODEV) {
 			generate_local_error(error, HINAWA_FW_NODE_ERROR_DISCONNECTED);
@@ -395,7 +889,7 @@ gboolean hinawa_fw_node_open(HinawaFwNode *self, const gchar *path, gint open_fl
 	}
 
 	g_mutex_lock(&priv->mutex);
-	err = update_info(self);
+	err = update_info(self, &rom_changed);
 	g_mutex_unlock(&priv->mutex);
 
 	if (err > 0) {
@@ -403,194 +897,1167 @@ gboolean hinawa_fw_node_open(HinawaFwNode *self, const gchar *path, gint open_fl
 			generate_local_error(error, HINAWA_FW_NODE_ERROR_DISCONNECTED);
 		else
 			generate_syscall_error(error, errno, "ioctl(%s)", "FW_CDEV_IOC_GET_INFO");
-		close(priv->fd);
+		priv->backend->close(priv->fd, priv->backend_data);
 		priv->fd = -1;
 
 		return FALSE;
 	}
 
+	priv->path = g_strdup(path);
+
 	return TRUE;
 }
 
+// The default number of workers to open nodes in parallel.
+#define DEFAULT_OPEN_WORKERS	8
+
+struct open_task {
+	const gchar *path;
+	gint open_flag;
+	HinawaFwNode *node;
+	GError *error;
+};
+
+static void run_open_task(gpointer data, gpointer user_data)
+{
+	struct open_task *task = data;
+	HinawaFwNode *node = hinawa_fw_node_new();
+
+	if (hinawa_fw_node_open(node, task->path, task->open_flag, &task->error))
+		task->node = node;
+	else
+		g_object_unref(node);
+}
+
+// The elements of arrays are NULL for the failed or succeeded paths.
+static void clear_node(gpointer data)
+{
+	if (data != NULL)
+		g_object_unref(data);
+}
+
+static void clear_error(gpointer data)
+{
+	if (data != NULL)
+		g_error_free(data);
+}
+
 /**
- * hinawa_fw_node_get_config_rom:
- * @self: A [class@FwNode]
- * @image: (array length=length)(out)(transfer none): The content of configuration ROM.
- * @length: (out): The number of bytes consists of the configuration ROM.
- * @error: A [struct@GLib.Error].
+ * hinawa_fw_node_open_bulk:
+ * @paths: (array zero-terminated=1): The paths to Linux FireWire character devices.
+ * @open_flag: The flag of `open(2)` system call. `O_RDONLY` is fulfilled internally.
+ * @max_workers: The maximum number of threads to open nodes in parallel, or zero for the default.
+ * @nodes: (out)(transfer full)(element-type FwNode): The array of nodes opened for each path in
+ *	   the same order. The element is %NULL when failed.
+ * @errors: (out)(transfer full)(element-type GLib.Error): The array of errors for each path in
+ *	    the same order. The element is %NULL when succeeded.
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@GLib.ThreadError].
  *
- * Get cached content of configuration ROM aligned to big-endian.
+ * Instantiate [class@FwNode] and open the character device for each of the given paths. The
+ * operations including `open(2)` and `FW_CDEV_IOC_GET_INFO` are executed by the pool of worker
+ * threads so that the stall of one device does not block the others.
  *
- * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ * Returns: TRUE if the pool of worker threads is available, otherwise FALSE. The result for each
+ *	    path is available in @nodes and @errors.
  *
- * Since: 4.0
+ * Since: 4.1
  */
-gboolean hinawa_fw_node_get_config_rom(HinawaFwNode *self, const guint8 **image, gsize *length,
-				       GError **error)
+gboolean hinawa_fw_node_open_bulk(const gchar *const *paths, gint open_flag, guint max_workers,
+				  GPtrArray **nodes, GPtrArray **errors, GError **error)
 {
-	HinawaFwNodePrivate *priv;
-
-	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
-	g_return_val_if_fail(image != NULL, FALSE);
-	g_return_val_if_fail(length != NULL, FALSE);
+	struct open_task *tasks;
+	GThreadPool *pool;
+	guint count;
+	guint i;
+
+	g_return_val_if_fail(paths != NULL, FALSE);
+	g_return_val_if_fail(nodes != NULL, FALSE);
+	g_return_val_if_fail(errors != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	priv = hinawa_fw_node_get_instance_private(self);
-	if (priv->fd < 0) {
-		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+	count = g_strv_length((gchar **)paths);
+	if (max_workers == 0)
+		max_workers = DEFAULT_OPEN_WORKERS;
+	max_workers = MAX(MIN(max_workers, count), 1);
+
+	pool = g_thread_pool_new(run_open_task, NULL, max_workers, FALSE, error);
+	if (pool == NULL)
 		return FALSE;
-	}
 
-	g_mutex_lock(&priv->mutex);
+	tasks = g_new0(struct open_task, count);
+	for (i = 0; i < count; ++i) {
+		tasks[i].path = paths[i];
+		tasks[i].open_flag = open_flag;
+		g_thread_pool_push(pool, tasks + i, NULL);
+	}
 
-	*image = priv->config_rom;
-	*length = priv->config_rom_length;
+	// Wait for all of tasks.
+	g_thread_pool_free(pool, FALSE, TRUE);
 
-	g_mutex_unlock(&priv->mutex);
+	*nodes = g_ptr_array_new_full(count, clear_node);
+	*errors = g_ptr_array_new_full(count, clear_error);
+	for (i = 0; i < count; ++i) {
+		g_ptr_array_add(*nodes, tasks[i].node);
+		g_ptr_array_add(*errors, tasks[i].error);
+	}
+	g_free(tasks);
 
 	return TRUE;
 }
 
-/**
- * hinawa_fw_node_read_cycle_time:
- * @self: A [class@FwNode]
- * @clock_id: The numeric ID of clock source for the reference timestamp. One of CLOCK_REALTIME(0),
- *	      CLOCK_MONOTONIC(1), and CLOCK_MONOTONIC_RAW(4) is available in UAPI of Linux kernel.
- * @cycle_time: (inout): A [struct@CycleTime].
- * @error: A [struct@GLib.Error].
- *
- * Read current value of CYCLE_TIME register in 1394 OHCI hardware dedicated to communicate with
- * the associated node in IEEE 1394 bus.
- *
- * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
- *
- * Since: 4.0
- */
-gboolean hinawa_fw_node_read_cycle_time(HinawaFwNode *self, gint clock_id,
-					HinawaCycleTime **cycle_time, GError **error)
+HinawaFwNodeTraceEntry *hinawa_fw_node_trace_entry_copy(const HinawaFwNodeTraceEntry *self)
 {
-	int err;
+	HinawaFwNodeTraceEntry *entry = g_malloc(sizeof(*entry));
 
-	g_return_val_if_fail(cycle_time != NULL, FALSE);
-
-	(*cycle_time)->clk_id = clock_id;
-	err = hinawa_fw_node_ioctl(self, FW_CDEV_IOC_GET_CYCLE_TIMER2, *cycle_time, error);
-	if (err < 0 && *error == NULL)
-		generate_syscall_error(error, errno, "ioctl(%s)", "FW_CDEV_IOC_GET_CYCLE_TIMER2");
+	memcpy(entry, self, sizeof(*entry));
 
-	return err == 0;
+	return entry;
 }
 
-static void handle_update(HinawaFwNode *self)
+G_DEFINE_BOXED_TYPE(HinawaFwNodeTraceEntry, hinawa_fw_node_trace_entry,
+		    hinawa_fw_node_trace_entry_copy, g_free)
+
+/**
+ * hinawa_fw_node_dump_trace:
+ * @self: A [class@FwNode].
+ * @entries: (array length=count)(out)(transfer full): The entries of trace from the oldest.
+ * @count: (out): The number of entries.
+ *
+ * Retrieve the latest entries in the ring to trace events, enabled by
+ * [property@FwNode:trace-size]. The entry overwritten during the retrieval is skipped. The
+ * writer in the path of dispatch is never blocked.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_node_dump_trace(HinawaFwNode *self, HinawaFwNodeTraceEntry **entries,
+			       gsize *count)
 {
 	HinawaFwNodePrivate *priv;
+	guint head;
+	guint length;
+	guint i;
 
 	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+	g_return_if_fail(entries != NULL);
+	g_return_if_fail(count != NULL);
+
 	priv = hinawa_fw_node_get_instance_private(self);
 
-	g_mutex_lock(&priv->mutex);
-	update_info(self);
-	g_mutex_unlock(&priv->mutex);
+	head = g_atomic_int_get(&priv->trace_head);
+	length = MIN(head, priv->trace_size);
 
-	g_signal_emit(self, fw_node_sigs[FW_NODE_SIG_TYPE_BUS_UPDATE], 0, NULL);
-}
+	*entries = g_new0(HinawaFwNodeTraceEntry, MAX(length, 1));
+	*count = 0;
 
-static gboolean check_src(GSource *gsrc)
-{
-	FwNodeSource *src = (FwNodeSource *)gsrc;
-	GIOCondition condition;
+	for (i = head - length; i != head; ++i) {
+		const struct trace_slot *slot = priv->trace + (i & (priv->trace_size - 1));
+		HinawaFwNodeTraceEntry *entry = *entries + *count;
+		gint seq;
 
-	// Don't go to dispatch if nothing available. As an error, return
-	// TRUE for POLLERR to call .dispatch for internal destruction.
-	condition = g_source_query_unix_fd(gsrc, src->tag);
-	return !!(condition & (G_IO_IN | G_IO_ERR));
+		seq = g_atomic_int_get(&slot->seq);
+		if (seq & 1)
+			continue;
+		memcpy(entry, &slot->entry, sizeof(*entry));
+		if (slot->index != i || seq != g_atomic_int_get(&slot->seq))
+			continue;
+
+		++(*count);
+	}
 }
 
-static gboolean dispatch_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+HinawaFwNodeStats *hinawa_fw_node_stats_copy(const HinawaFwNodeStats *self)
 {
-	FwNodeSource *src = (FwNodeSource *)gsrc;
-	HinawaFwNodePrivate *priv;
-	GIOCondition condition;
-	const union fw_cdev_event *event;
-	gpointer instance;
-	__u32 event_type;
-	ssize_t len;
+	HinawaFwNodeStats *stats = g_malloc(sizeof(*stats));
 
-	priv = hinawa_fw_node_get_instance_private(src->self);
-	if (priv->fd < 0)
-		return G_SOURCE_REMOVE;
+	memcpy(stats, self, sizeof(*stats));
 
-	condition = g_source_query_unix_fd(gsrc, src->tag);
-	if (condition & G_IO_ERR) {
-		g_signal_emit(src->self,
-			fw_node_sigs[FW_NODE_SIG_TYPE_DISCONNECTED], 0);
-		return G_SOURCE_REMOVE;
-	}
+	return stats;
+}
 
-	len = read(priv->fd, src->buf, src->len);
-	if (len < 0) {
-		if (errno == EAGAIN)
-			return G_SOURCE_CONTINUE;
+G_DEFINE_BOXED_TYPE(HinawaFwNodeStats, hinawa_fw_node_stats, hinawa_fw_node_stats_copy, g_free)
 
-		return G_SOURCE_REMOVE;
+/**
+ * hinawa_fw_node_get_stats:
+ * @self: A [class@FwNode].
+ * @stats: (out)(transfer full): The snapshot of counters.
+ *
+ * Retrieve the snapshot of counters for performance since the instance is created. Each counter
+ * is read independently, thus the snapshot is not necessarily consistent across counters while
+ * the events are dispatched.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_node_get_stats(HinawaFwNode *self, HinawaFwNodeStats **stats)
+{
+	HinawaFwNodePrivate *priv;
+	HinawaFwNodeStats *snapshot;
+	int i;
+
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+	g_return_if_fail(stats != NULL);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	snapshot = g_new0(HinawaFwNodeStats, 1);
+
+	for (i = 0; i < HINAWA_FW_NODE_STATS_EVENT_TYPES; ++i)
+		snapshot->events[i] = stats_get(priv->stats.events[i]);
+	snapshot->bytes_read = stats_get(priv->stats.bytes_read);
+	for (i = 0; i < HINAWA_FW_NODE_STATS_IOCTL_CODES; ++i) {
+		snapshot->ioctl_calls[i] = stats_get(priv->stats.ioctl_calls[i]);
+		snapshot->ioctl_errors[i] = stats_get(priv->stats.ioctl_errors[i]);
+	}
+	for (i = 0; i < HINAWA_FW_NODE_STATS_BUCKETS; ++i) {
+		snapshot->dispatch_latency[i] = stats_get(priv->stats.dispatch_latency[i]);
+		snapshot->round_trip_time[i] = stats_get(priv->stats.round_trip_time[i]);
+	}
+
+	g_mutex_lock(&priv->transactions_mutex);
+	snapshot->transactions_in_flight = g_hash_table_size(priv->transactions);
+	g_mutex_unlock(&priv->transactions_mutex);
+
+	*stats = snapshot;
+}
+
+/**
+ * hinawa_fw_node_get_bus_state:
+ * @self: A [class@FwNode].
+ * @generation: (out)(optional): The current generation of bus topology.
+ * @node_id: (out)(optional): The node ID of node associated to the instance.
+ * @local_node_id: (out)(optional): The node ID of node which the host controller plays.
+ * @bus_manager_node_id: (out)(optional): The node ID of bus manager.
+ * @ir_manager_node_id: (out)(optional): The node ID of isochronous resource manager.
+ * @root_node_id: (out)(optional): The node ID of root node.
+ * @card_id: (out)(optional): The numeric ID of 1394 OHCI hardware.
+ *
+ * Retrieve the state of bus at current generation at once. Any of the arguments can be %NULL
+ * when the value is not required. The values are consistent each other, while they are
+ * retrieved without any lock. It is preferable to the access of each property in hot paths
+ * such as the thread to issue a batch of transactions.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_node_get_bus_state(HinawaFwNode *self, guint *generation, guint *node_id,
+				  guint *local_node_id, guint *bus_manager_node_id,
+				  guint *ir_manager_node_id, guint *root_node_id, guint *card_id)
+{
+	HinawaFwNodePrivate *priv;
+	struct bus_state *state;
+	struct bus_state snapshot;
+	gint seq;
+
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	state = &priv->bus_state;
+
+	// Retry while the writer updates the state.
+	do {
+		seq = g_atomic_int_get(&state->seq);
+		if (seq & 1)
+			continue;
+
+		snapshot.generation = g_atomic_int_get(&state->generation);
+		snapshot.node_id = g_atomic_int_get(&state->node_id);
+		snapshot.local_node_id = g_atomic_int_get(&state->local_node_id);
+		snapshot.bm_node_id = g_atomic_int_get(&state->bm_node_id);
+		snapshot.irm_node_id = g_atomic_int_get(&state->irm_node_id);
+		snapshot.root_node_id = g_atomic_int_get(&state->root_node_id);
+		snapshot.card_id = g_atomic_int_get(&state->card_id);
+	} while ((seq & 1) || seq != g_atomic_int_get(&state->seq));
+
+	if (generation != NULL)
+		*generation = snapshot.generation;
+	if (node_id != NULL)
+		*node_id = snapshot.node_id;
+	if (local_node_id != NULL)
+		*local_node_id = snapshot.local_node_id;
+	if (bus_manager_node_id != NULL)
+		*bus_manager_node_id = snapshot.bm_node_id;
+	if (ir_manager_node_id != NULL)
+		*ir_manager_node_id = snapshot.irm_node_id;
+	if (root_node_id != NULL)
+		*root_node_id = snapshot.root_node_id;
+	if (card_id != NULL)
+		*card_id = snapshot.card_id;
+}
+
+/**
+ * hinawa_fw_node_get_config_rom:
+ * @self: A [class@FwNode]
+ * @image: (array length=length)(out)(transfer none): The content of configuration ROM.
+ * @length: (out): The number of bytes consists of the configuration ROM.
+ * @error: A [struct@GLib.Error].
+ *
+ * Get cached content of configuration ROM aligned to big-endian. The content is kept as is
+ * till the instance is finalized even if it is changed by bus reset. Use
+ * [method@FwNode.get_config_rom_bytes] to retrieve the latest snapshot.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.0
+ */
+gboolean hinawa_fw_node_get_config_rom(HinawaFwNode *self, const guint8 **image, gsize *length,
+				       GError **error)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	g_return_val_if_fail(image != NULL, FALSE);
+	g_return_val_if_fail(length != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	if (priv->fd < 0) {
+		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+		return FALSE;
+	}
+
+	g_mutex_lock(&priv->mutex);
+
+	*image = g_bytes_get_data(priv->config_rom, length);
+	priv->config_rom_exposed = TRUE;
+
+	g_mutex_unlock(&priv->mutex);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_node_get_config_rom_bytes:
+ * @self: A [class@FwNode]
+ * @bytes: (out)(transfer full): The snapshot of content of configuration ROM aligned to
+ *	   big-endian.
+ * @error: A [struct@GLib.Error].
+ *
+ * Get the snapshot of cached content of configuration ROM. The snapshot is immutable and
+ * replaced with new one when the content is changed by bus reset, thus the caller can parse it
+ * without any copy or lock as long as it owns the reference.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_node_get_config_rom_bytes(HinawaFwNode *self, GBytes **bytes, GError **error)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	g_return_val_if_fail(bytes != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	if (priv->fd < 0) {
+		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+		return FALSE;
+	}
+
+	g_mutex_lock(&priv->mutex);
+	*bytes = g_bytes_ref(priv->config_rom);
+	g_mutex_unlock(&priv->mutex);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_node_get_config_rom_index:
+ * @self: A [class@FwNode]
+ * @index: (out)(transfer full): The index of content of configuration ROM.
+ * @error: A [struct@GLib.Error].
+ *
+ * Get the index of cached content of configuration ROM. The index is built at the first call
+ * after the content is changed, then shared by subsequent calls.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_node_get_config_rom_index(HinawaFwNode *self, HinawaConfigRom **index,
+					     GError **error)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	g_return_val_if_fail(index != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	if (priv->fd < 0) {
+		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+		return FALSE;
+	}
+
+	g_mutex_lock(&priv->mutex);
+	if (priv->config_rom_index == NULL)
+		priv->config_rom_index = hinawa_config_rom_new(priv->config_rom);
+	*index = hinawa_config_rom_ref(priv->config_rom_index);
+	g_mutex_unlock(&priv->mutex);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_node_read_cycle_time:
+ * @self: A [class@FwNode]
+ * @clock_id: The numeric ID of clock source for the reference timestamp. One of CLOCK_REALTIME(0),
+ *	      CLOCK_MONOTONIC(1), and CLOCK_MONOTONIC_RAW(4) is available in UAPI of Linux kernel.
+ * @cycle_time: (inout): A [struct@CycleTime].
+ * @error: A [struct@GLib.Error].
+ *
+ * Read current value of CYCLE_TIME register in 1394 OHCI hardware dedicated to communicate with
+ * the associated node in IEEE 1394 bus.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.0
+ */
+gboolean hinawa_fw_node_read_cycle_time(HinawaFwNode *self, gint clock_id,
+					HinawaCycleTime **cycle_time, GError **error)
+{
+	int err;
+
+	g_return_val_if_fail(cycle_time != NULL, FALSE);
+
+	(*cycle_time)->clk_id = clock_id;
+	err = hinawa_fw_node_ioctl(self, FW_CDEV_IOC_GET_CYCLE_TIMER2, *cycle_time, error);
+	if (err < 0 && *error == NULL)
+		generate_syscall_error(error, errno, "ioctl(%s)", "FW_CDEV_IOC_GET_CYCLE_TIMER2");
+
+	return err == 0;
+}
+
+// The transactions in flight at the older generation are stale after bus reset. Finish them
+// immediately instead of waiting for timeout, or reissue them at the new generation. The
+// transactions issued at the new generation by the other thread after the generation is
+// updated are not touched.
+static void handle_stale_transactions(HinawaFwNode *self, guint32 generation)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GList *entries = NULL;
+	GList *entry;
+
+	g_mutex_lock(&priv->transactions_mutex);
+	g_hash_table_iter_init(&iter, priv->transactions);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		const struct hinawa_fw_req_transaction *transaction = value;
+
+		// The generation wraps around.
+		if ((gint32)(generation - transaction->generation) <= 0)
+			continue;
+
+		entries = g_list_prepend(entries, key);
+		g_hash_table_iter_steal(&iter);
+	}
+	g_mutex_unlock(&priv->transactions_mutex);
+
+	for (entry = entries; entry != NULL; entry = entry->next) {
+		HinawaFwReq *req = entry->data;
+
+		hinawa_fw_req_handle_bus_reset(req, self);
+		g_object_unref(req);
+	}
+
+	g_list_free(entries);
+}
+
+// The signal is emitted just once even if several sources detect the disconnection.
+static void emit_disconnected(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+
+	if (g_atomic_int_compare_and_exchange(&priv->disconnected, 0, 1))
+		g_signal_emit(self, fw_node_sigs[FW_NODE_SIG_TYPE_DISCONNECTED], 0);
+}
+
+// NOTE: For HinawaFwMonitor, internal.
+void hinawa_fw_node_handle_disconnection(HinawaFwNode *self)
+{
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+
+	emit_disconnected(self);
+}
+
+// NOTE: For HinawaFwMonitor, internal. The path is immutable after opened.
+const gchar *hinawa_fw_node_get_path(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), NULL);
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	return priv->path;
+}
+
+static void handle_update(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv;
+	HinawaFwNodeClass *klass;
+	gboolean rom_changed = FALSE;
+	struct hinawa_callback *cb;
+	guint32 generation;
+	gboolean direct;
+
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	g_mutex_lock(&priv->mutex);
+	update_info(self, &rom_changed);
+	generation = priv->generation.generation;
+	g_mutex_unlock(&priv->mutex);
+
+	handle_stale_transactions(self, generation);
+
+	if (rom_changed)
+		g_signal_emit(self, fw_node_sigs[FW_NODE_SIG_TYPE_CONFIG_ROM_CHANGED], 0);
+
+	// The function is called at first, then the signal is emitted just for connected handlers
+	// or the class closure.
+	cb = hinawa_callback_get(&priv->bus_update_cb, &priv->callback_mutex);
+	direct = cb != NULL;
+	if (direct) {
+		((HinawaFwNodeBusUpdateFunc)cb->func)(self, cb->data);
+		hinawa_callback_unref(cb);
+	}
+
+	klass = HINAWA_FW_NODE_GET_CLASS(self);
+	if (!direct ||
+	    g_signal_has_handler_pending(self, fw_node_sigs[FW_NODE_SIG_TYPE_BUS_UPDATE], 0, FALSE))
+		g_signal_emit(self, fw_node_sigs[FW_NODE_SIG_TYPE_BUS_UPDATE], 0, NULL);
+	else if (klass->bus_update != NULL)
+		klass->bus_update(self);
+}
+
+/**
+ * hinawa_fw_node_set_bus_update_func:
+ * @self: A [class@FwNode].
+ * @func: (scope notified)(closure user_data)(destroy notify)(nullable): The function called
+ *	  when IEEE 1394 bus is updated, or NULL to unset it.
+ * @user_data: The data passed to @func.
+ * @notify: (nullable): The function called to release @user_data when @func is unset.
+ *
+ * Set the function called with the same arguments as [signal@FwNode::bus-update], before the
+ * signal is emitted. The function is called directly in the thread to dispatch events. When the
+ * function is set, the signal is emitted only if any handler is connected to the signal or the
+ * class closure is overridden. The function is called without any lock, thus it can set the
+ * other function. The @notify is called after the function is unset and the call in progress
+ * returns.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_node_set_bus_update_func(HinawaFwNode *self, HinawaFwNodeBusUpdateFunc func,
+					gpointer user_data, GDestroyNotify notify)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	hinawa_callback_replace(&priv->bus_update_cb, &priv->callback_mutex,
+				hinawa_callback_new(G_CALLBACK(func), user_data, notify));
+}
+
+static gboolean check_src(GSource *gsrc)
+{
+	FwNodeSource *src = (FwNodeSource *)gsrc;
+	GIOCondition condition;
+
+	// Don't go to dispatch if nothing available. As an error, return
+	// TRUE for POLLERR to call .dispatch for internal destruction.
+	condition = g_source_query_unix_fd(gsrc, src->tag);
+	return !!(condition & (G_IO_IN | G_IO_ERR));
+}
+
+// The bucket n counts the duration less than 2^(n + 1) microseconds.
+static void record_duration(guint64 *histogram, gint64 usec)
+{
+	guint bucket = 0;
+
+	if (usec > 1)
+		bucket = MIN(g_bit_storage(usec) - 1, HINAWA_FW_NODE_STATS_BUCKETS - 1);
+
+	stats_add(histogram[bucket], 1);
+}
+
+static void record_trace(HinawaFwNodePrivate *priv, const union fw_cdev_event *event,
+			 guint closure_kind)
+{
+	guint index = g_atomic_int_add(&priv->trace_head, 1);
+	struct trace_slot *slot = priv->trace + (index & (priv->trace_size - 1));
+	HinawaFwNodeTraceEntry *entry = &slot->entry;
+
+	g_atomic_int_inc(&slot->seq);
+
+	slot->index = index;
+	entry->event_type = event->common.type;
+	entry->closure_kind = closure_kind;
+	entry->tstamp = G_MAXUINT;
+	entry->monotonic_time = g_get_monotonic_time();
+
+	switch (event->common.type) {
+	case FW_CDEV_EVENT_REQUEST:
+		entry->length = event->request.length;
+		break;
+	case FW_CDEV_EVENT_REQUEST2:
+		entry->length = event->request2.length;
+		break;
+	case FW_CDEV_EVENT_REQUEST3:
+		entry->length = event->request3.length;
+		entry->tstamp = event->request3.tstamp;
+		break;
+	case FW_CDEV_EVENT_RESPONSE:
+		entry->length = event->response.length;
+		break;
+	case FW_CDEV_EVENT_RESPONSE2:
+		entry->length = event->response2.length;
+		entry->tstamp = event->response2.response_tstamp;
+		break;
+	default:
+		entry->length = 0;
+		break;
+	}
+
+	g_atomic_int_inc(&slot->seq);
+}
+
+static void dispatch_event(HinawaFwNode *self, const union fw_cdev_event *event)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	enum hinawa_closure_kind kind;
+	gpointer instance;
+	__u32 event_type;
+
+	// The completion for the instance released in advance is rejected here.
+	instance = hinawa_closure_lookup(event->common.closure, &kind);
+	event_type = event->common.type;
+
+	if (priv->trace != NULL)
+		record_trace(priv, event, instance != NULL ? kind : 0);
+
+	if (instance == NULL)
+		return;
+
+	switch (kind) {
+	case HINAWA_CLOSURE_KIND_FW_NODE:
+		if (event_type == FW_CDEV_EVENT_BUS_RESET)
+			handle_update(self);
+		break;
+	case HINAWA_CLOSURE_KIND_FW_RESP:
+	{
+		HinawaFwResp *resp = instance;
+
+		switch (event_type) {
+		case FW_CDEV_EVENT_REQUEST:
+			hinawa_fw_resp_handle_request(resp, &event->request);
+			break;
+		case FW_CDEV_EVENT_REQUEST2:
+			hinawa_fw_resp_handle_request2(resp, &event->request2);
+			break;
+		case FW_CDEV_EVENT_REQUEST3:
+			hinawa_fw_resp_handle_request3(resp, &event->request3);
+			break;
+		default:
+			break;
+		}
+		break;
+	}
+	case HINAWA_CLOSURE_KIND_FW_REQ:
+	{
+		HinawaFwReq *req = instance;
+		const struct hinawa_fw_req_transaction *transaction;
+		gint64 issued = 0;
+		gboolean found;
+
+		// Don't process request invalidated in advance. The entry is removed under the lock,
+		// then the response is handled without it so that the handler can issue the next
+		// request.
+		g_mutex_lock(&priv->transactions_mutex);
+		transaction = g_hash_table_lookup(priv->transactions, req);
+		found = transaction != NULL;
+		if (found) {
+			issued = transaction->issued;
+			g_hash_table_remove(priv->transactions, req);
+		}
+		g_mutex_unlock(&priv->transactions_mutex);
+
+		if (!found)
+			break;
+
+		record_duration(priv->stats.round_trip_time, g_get_monotonic_time() - issued);
+
+		switch (event_type) {
+		case FW_CDEV_EVENT_RESPONSE:
+			hinawa_fw_req_handle_response(req, &event->response);
+			break;
+		case FW_CDEV_EVENT_RESPONSE2:
+			hinawa_fw_req_handle_response2(req, &event->response2);
+			break;
+		default:
+			break;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	g_object_unref(instance);
+}
+
+static HinawaFwNodeEventClass classify_event(__u32 event_type)
+{
+	switch (event_type) {
+	case FW_CDEV_EVENT_BUS_RESET:
+		return HINAWA_FW_NODE_EVENT_CLASS_BUS_RESET;
+	case FW_CDEV_EVENT_RESPONSE:
+	case FW_CDEV_EVENT_RESPONSE2:
+		return HINAWA_FW_NODE_EVENT_CLASS_RESPONSE;
+	case FW_CDEV_EVENT_REQUEST:
+	case FW_CDEV_EVENT_REQUEST2:
+	case FW_CDEV_EVENT_REQUEST3:
+		return HINAWA_FW_NODE_EVENT_CLASS_REQUEST;
+	default:
+		return 0;
+	}
+}
+
+// Forward the event to the first filtered source for the class of event. Return FALSE when
+// no source is for it.
+static gboolean forward_event(HinawaFwNodePrivate *priv, const union fw_cdev_event *event)
+{
+	HinawaFwNodeEventClass class = classify_event(event->common.type);
+	gboolean forwarded = FALSE;
+	int i;
+
+	if (class == 0)
+		return FALSE;
+
+	g_mutex_lock(&priv->filters_mutex);
+
+	i = 0;
+	while (i < priv->filters->len) {
+		FwNodeFilteredSource *src = g_ptr_array_index(priv->filters, i);
+
+		// Release the source destroyed by the user.
+		if (g_source_is_destroyed((GSource *)src)) {
+			g_ptr_array_remove_index(priv->filters, i);
+			g_atomic_int_set(&priv->filter_count, priv->filters->len);
+			continue;
+		}
+
+		if (src->classes & class) {
+			// The buffer is shared with the source.
+			g_async_queue_push(src->queue, hinawa_buffer_ref((gpointer)event));
+			g_source_set_ready_time((GSource *)src, 0);
+			forwarded = TRUE;
+			break;
+		}
+
+		++i;
+	}
+
+	g_mutex_unlock(&priv->filters_mutex);
+
+	return forwarded;
+}
+
+// The event should be in the buffer taken from the pool.
+static void handle_event(HinawaFwNode *self, const union fw_cdev_event *event)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	__u32 event_type = event->common.type;
+
+	HINAWA_PROBE3(event_read, self, event_type, event->common.closure);
+
+	if (event_type < HINAWA_FW_NODE_STATS_EVENT_TYPES)
+		stats_add(priv->stats.events[event_type], 1);
+
+	// The list is not empty only when any filtered source is created.
+	if (g_atomic_int_get(&priv->filter_count) > 0 && forward_event(priv, event))
+		return;
+
+	dispatch_event(self, event);
+}
+
+// Linux FireWire subsystem doesn't support non-blocking read for the character device, thus
+// check whether any event is queued in advance.
+static gboolean event_is_queued(int fd)
+{
+	struct pollfd pfd = {
+		.fd = fd,
+		.events = POLLIN,
+	};
+
+	return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
+}
+
+// Reject the request at the stale generation without emitting signal.
+static gboolean reject_stale_request(HinawaFwNode *self, const union fw_cdev_event *event,
+				     guint generation)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	struct fw_cdev_send_response resp = {0};
+	GError *error = NULL;
+	__u32 event_type = event->common.type;
+
+	if (event_type == FW_CDEV_EVENT_REQUEST2 && event->request2.generation != generation)
+		resp.handle = event->request2.handle;
+	else if (event_type == FW_CDEV_EVENT_REQUEST3 && event->request3.generation != generation)
+		resp.handle = event->request3.handle;
+	else
+		return FALSE;
+
+	HINAWA_PROBE3(event_read, self, event_type, event->common.closure);
+	stats_add(priv->stats.events[event_type], 1);
+
+	// Ignore ioctl error.
+	resp.rcode = RCODE_CONFLICT_ERROR;
+	hinawa_fw_node_ioctl(self, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error);
+	g_clear_error(&error);
+
+	return TRUE;
+}
+
+static gboolean event_is_response(const union fw_cdev_event *event)
+{
+	return event->common.type == FW_CDEV_EVENT_RESPONSE ||
+	       event->common.type == FW_CDEV_EVENT_RESPONSE2;
+}
+
+// Handle the latest event of bus reset in the batch at first, then the others in the order. The
+// responses queued before the event are handled ahead of it since the transactions are finished
+// at the former generation.
+static void handle_batch(HinawaFwNode *self, GPtrArray *batch)
+{
+	const union fw_cdev_event *bus_reset = NULL;
+	guint bus_reset_index = 0;
+	guint generation;
+	guint i;
+
+	for (i = 0; i < batch->len; ++i) {
+		const union fw_cdev_event *event = g_ptr_array_index(batch, i);
+
+		if (event->common.type == FW_CDEV_EVENT_BUS_RESET) {
+			bus_reset = event;
+			bus_reset_index = i;
+		}
+	}
+
+	if (bus_reset != NULL) {
+		for (i = 0; i < bus_reset_index; ++i) {
+			const union fw_cdev_event *event = g_ptr_array_index(batch, i);
+
+			if (event_is_response(event))
+				handle_event(self, event);
+		}
+
+		handle_event(self, bus_reset);
+		hinawa_fw_node_get_bus_state(self, &generation, NULL, NULL, NULL, NULL, NULL, NULL);
+	}
+
+	for (i = 0; i < batch->len; ++i) {
+		const union fw_cdev_event *event = g_ptr_array_index(batch, i);
+
+		if (bus_reset != NULL) {
+			if (event->common.type == FW_CDEV_EVENT_BUS_RESET)
+				continue;
+			if (i < bus_reset_index && event_is_response(event))
+				continue;
+			if (reject_stale_request(self, event, generation))
+				continue;
+		}
+		handle_event(self, event);
+	}
+}
+
+// Process queued events within the budget. Return FALSE when the character device is not
+// available anymore.
+static gboolean process_events(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(self);
+	guint event_budget;
+	guint time_budget;
+	gboolean prioritize_bus_reset;
+	GPtrArray *batch = NULL;
+	gint64 begin;
+	gint64 deadline;
+	guint count;
+	guint syscalls;
+	gboolean result;
+
+	event_budget = param_get(priv->dispatch_event_budget);
+	time_budget = param_get(priv->dispatch_time_budget);
+	prioritize_bus_reset = param_get(priv->prioritize_bus_reset);
+
+	// The events are handled after reading them.
+	if (prioritize_bus_reset)
+		batch = g_ptr_array_new_with_free_func(hinawa_buffer_unref);
+
+	begin = g_get_monotonic_time();
+	if (time_budget > 0)
+		deadline = begin + time_budget;
+	else
+		deadline = G_MAXINT64;
+
+	result = TRUE;
+
+	count = 0;
+	syscalls = 0;
+	while (TRUE) {
+		void *buf = hinawa_buffer_pool_acquire(priv->pool);
+		ssize_t len = priv->backend->read(priv->fd, buf,
+						  hinawa_buffer_pool_get_size(priv->pool),
+						  priv->backend_data);
+		++syscalls;
+		if (len < 0) {
+			hinawa_buffer_unref(buf);
+			if (errno != EAGAIN)
+				result = FALSE;
+			break;
+		}
+		stats_add(priv->stats.bytes_read, len);
+		hinawa_buffer_set_length(buf, len);
+
+		// The buffer is recycled unless any handler keeps the frame in it.
+		if (batch != NULL) {
+			g_ptr_array_add(batch, buf);
+		} else {
+			handle_event(self, buf);
+			hinawa_buffer_unref(buf);
+		}
+		++count;
+
+		if (event_budget > 0 && count >= event_budget)
+			break;
+		if (deadline < G_MAXINT64 && g_get_monotonic_time() >= deadline)
+			break;
+		++syscalls;
+		if (!event_is_queued(priv->fd))
+			break;
+	}
+
+	if (batch != NULL) {
+		handle_batch(self, batch);
+		g_ptr_array_unref(batch);
+	}
+
+	record_duration(priv->stats.dispatch_latency, g_get_monotonic_time() - begin);
+
+	stats_add(priv->dispatch_wakeups, 1);
+	stats_add(priv->dispatched_events, count);
+	stats_add(priv->dispatch_syscalls, syscalls);
+
+	return result;
+}
+
+// NOTE: For HinawaFwDispatcher, internal.
+int hinawa_fw_node_get_fd(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), -1);
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	return priv->fd;
+}
+
+// Internal use only. Return FALSE when the node is not available anymore.
+gboolean hinawa_fw_node_dispatch(HinawaFwNode *self, GIOCondition condition)
+{
+	HinawaFwNodePrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	if (priv->fd < 0)
+		return FALSE;
+
+	if (condition & (G_IO_ERR | G_IO_HUP)) {
+		emit_disconnected(self);
+		return FALSE;
 	}
 
-	event = (const union fw_cdev_event *)src->buf;
-	instance = (gpointer)event->common.closure;
-	event_type = event->common.type;
+	if (condition & G_IO_IN)
+		return process_events(self);
 
-	if (HINAWA_IS_FW_NODE(instance) && event_type == FW_CDEV_EVENT_BUS_RESET) {
-		handle_update(src->self);
-	} else if (HINAWA_IS_FW_RESP(instance)) {
-		HinawaFwResp *resp = HINAWA_FW_RESP(instance);
+	return TRUE;
+}
 
-		switch (event_type) {
-		case FW_CDEV_EVENT_REQUEST:
-			hinawa_fw_resp_handle_request(resp, &event->request);
-			break;
-		case FW_CDEV_EVENT_REQUEST2:
-			hinawa_fw_resp_handle_request2(resp, &event->request2);
-			break;
-		case FW_CDEV_EVENT_REQUEST3:
-			hinawa_fw_resp_handle_request3(resp, &event->request3);
-			break;
-		default:
-			break;
-		}
-	} else if (HINAWA_IS_FW_REQ(instance)) {
-		HinawaFwReq *req = HINAWA_FW_REQ(instance);
-		GList *entry;
+static gboolean dispatch_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+{
+	FwNodeSource *src = (FwNodeSource *)gsrc;
+	GIOCondition condition;
 
-		// Don't process request invalidated in advance.
-		g_mutex_lock(&priv->transactions_mutex);
-		entry = g_list_find(priv->transactions, req);
-		if (entry) {
-			priv->transactions = g_list_delete_link(priv->transactions, entry);
-
-			switch (event_type) {
-			case FW_CDEV_EVENT_RESPONSE:
-				hinawa_fw_req_handle_response(req, &event->response);
-				break;
-			case FW_CDEV_EVENT_RESPONSE2:
-				hinawa_fw_req_handle_response2(req, &event->response2);
-				break;
-			default:
-				break;
-			}
+	condition = g_source_query_unix_fd(gsrc, src->tag);
+	if (!hinawa_fw_node_dispatch(src->self, condition))
+		return G_SOURCE_REMOVE;
+
+	// Just be sure to continue to process this source.
+	return G_SOURCE_CONTINUE;
+}
+
+#ifdef HAVE_IO_URING
+// The file descriptor for the character device is not seekable.
+#define URING_READ_OFFSET	((__u64)-1)
+
+static gboolean submit_uring_read(FwNodeSource *src)
+{
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(src->self);
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&src->ring);
+	if (sqe == NULL)
+		return FALSE;
+
+	// The buffer is taken from the pool for each read, since the previous one can be kept.
+	if (src->buf == NULL)
+		src->buf = hinawa_buffer_pool_acquire(priv->pool);
+
+	io_uring_prep_read(sqe, priv->fd, src->buf, hinawa_buffer_pool_get_size(priv->pool),
+			   URING_READ_OFFSET);
+	io_uring_sqe_set_data(sqe, src->buf);
+	if (io_uring_submit(&src->ring) < 1)
+		return FALSE;
+	src->pending = TRUE;
+
+	return TRUE;
+}
+
+static gboolean dispatch_uring_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+{
+	FwNodeSource *src = (FwNodeSource *)gsrc;
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(src->self);
+	struct io_uring_cqe *cqe;
+	gint64 begin;
+	guint count;
+	int res;
+
+	if (priv->fd < 0)
+		return G_SOURCE_REMOVE;
+
+	// The completion queue is mapped to user space, thus no system call is required.
+	if (io_uring_peek_cqe(&src->ring, &cqe) < 0)
+		return G_SOURCE_CONTINUE;
+	begin = g_get_monotonic_time();
+	res = cqe->res;
+	io_uring_cqe_seen(&src->ring, cqe);
+	src->pending = FALSE;
+
+	count = 0;
+	if (res < 0) {
+		if (res == -ENODEV) {
+			emit_disconnected(src->self);
+			return G_SOURCE_REMOVE;
 		}
-		g_mutex_unlock(&priv->transactions_mutex);
+		if (res != -EINTR && res != -EAGAIN && res != -ECANCELED)
+			return G_SOURCE_REMOVE;
+	} else {
+		void *buf = src->buf;
+
+		src->buf = NULL;
+		stats_add(priv->stats.bytes_read, res);
+		hinawa_buffer_set_length(buf, res);
+		handle_event(src->self, buf);
+		hinawa_buffer_unref(buf);
+		++count;
 	}
 
-	// Just be sure to continue to process this source.
+	if (!submit_uring_read(src))
+		return G_SOURCE_REMOVE;
+
+	record_duration(priv->stats.dispatch_latency, g_get_monotonic_time() - begin);
+
+	stats_add(priv->dispatch_wakeups, 1);
+	stats_add(priv->dispatched_events, count);
+	stats_add(priv->dispatch_syscalls, 1);
+
 	return G_SOURCE_CONTINUE;
 }
 
-static void finalize_src(GSource *gsrc)
+static void finalize_uring_src(GSource *gsrc)
 {
 	FwNodeSource *src = (FwNodeSource *)gsrc;
 
-	g_free(src->buf);
+	if (!src->ring_ready) {
+		if (src->buf != NULL)
+			hinawa_buffer_unref(src->buf);
+		return;
+	}
+
+	// The read in flight should be cancelled and reaped before releasing the buffer, since
+	// the worker of io_uring can write to the buffer.
+	if (src->pending) {
+		struct io_uring_sqe *sqe = io_uring_get_sqe(&src->ring);
+		struct io_uring_cqe *cqe;
+
+		if (sqe != NULL) {
+			io_uring_prep_cancel(sqe, src->buf, 0);
+			io_uring_sqe_set_data(sqe, NULL);
+			io_uring_submit(&src->ring);
+		}
+
+		while (src->pending && io_uring_wait_cqe(&src->ring, &cqe) == 0) {
+			if (io_uring_cqe_get_data(cqe) == src->buf)
+				src->pending = FALSE;
+			io_uring_cqe_seen(&src->ring, cqe);
+		}
+	}
+
+	io_uring_queue_exit(&src->ring);
+	if (src->buf != NULL)
+		hinawa_buffer_unref(src->buf);
+}
+
+// The depth of queue enough for a read and the cancellation of it.
+#define URING_QUEUE_DEPTH	2
+
+// The io_uring bypasses the system calls interposed by the preloaded shim, thus it is just for
+// the character device. The shim does not interpose fstat(2).
+static gboolean fd_is_character_device(int fd)
+{
+	struct stat st;
+
+	return fstat(fd, &st) == 0 && S_ISCHR(st.st_mode);
+}
+
+static gboolean create_uring_source(HinawaFwNode *self, GSource **gsrc)
+{
+	static GSourceFuncs funcs = {
+		.check		= check_src,
+		.dispatch	= dispatch_uring_src,
+		.finalize	= finalize_uring_src,
+	};
+	FwNodeSource *src;
+
+	*gsrc = g_source_new(&funcs, sizeof(FwNodeSource));
+	src = (FwNodeSource *)(*gsrc);
+
+	g_source_set_name(*gsrc, "HinawaFwNode");
+
+	src->self = self;
+
+	// Fall back to read(2) when the running kernel doesn't support io_uring.
+	if (io_uring_queue_init(URING_QUEUE_DEPTH, &src->ring, 0) < 0) {
+		g_source_unref(*gsrc);
+		*gsrc = NULL;
+		return FALSE;
+	}
+	src->ring_ready = TRUE;
+
+	// The file descriptor of io_uring is readable when any completion is queued.
+	src->tag = g_source_add_unix_fd(*gsrc, src->ring.ring_fd, G_IO_IN);
+
+	if (!submit_uring_read(src)) {
+		g_source_unref(*gsrc);
+		*gsrc = NULL;
+		return FALSE;
+	}
+
+	return TRUE;
 }
+#endif
 
 /**
  * hinawa_fw_node_create_source:
@@ -599,7 +2066,9 @@ static void finalize_src(GSource *gsrc)
  * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
  *
  * Create [struct@GLib.Source] for [struct@GLib.MainContext] to dispatch events for the node on
- * IEEE 1394 bus.
+ * IEEE 1394 bus. The number of events processed in a single dispatch is limited by
+ * [property@FwNode:dispatch-event-budget] and [property@FwNode:dispatch-time-budget]. When
+ * [property@FwNode:io-uring] is enabled, the source reads events by io_uring if available.
  *
  * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
  *
@@ -610,7 +2079,6 @@ gboolean hinawa_fw_node_create_source(HinawaFwNode *self, GSource **gsrc, GError
         static GSourceFuncs funcs = {
                 .check          = check_src,
                 .dispatch       = dispatch_src,
-                .finalize       = finalize_src,
         };
 	HinawaFwNodePrivate *priv;
 	FwNodeSource *src;
@@ -625,26 +2093,386 @@ gboolean hinawa_fw_node_create_source(HinawaFwNode *self, GSource **gsrc, GError
 		return FALSE;
 	}
 
+#ifdef HAVE_IO_URING
+	// The io_uring reads the character device directly.
+	if (priv->io_uring && priv->backend == &hinawa_fw_node_kernel_backend &&
+	    fd_is_character_device(priv->fd) && create_uring_source(self, gsrc))
+		return TRUE;
+#endif
+
         *gsrc = g_source_new(&funcs, sizeof(FwNodeSource));
 	src = (FwNodeSource *)(*gsrc);
 
         g_source_set_name(*gsrc, "HinawaFwNode");
 
-        // MEMO: allocate one page because we cannot assume the size of
-        // transaction frame.
-        src->len = sysconf(_SC_PAGESIZE);
-        src->buf = g_malloc0(src->len);
-
 	src->self = self;
 	src->tag = g_source_add_unix_fd(*gsrc, priv->fd, G_IO_IN);
 
 	return TRUE;
 }
 
+static gboolean dispatch_filtered_src(GSource *gsrc, GSourceFunc cb, gpointer user_data)
+{
+	FwNodeFilteredSource *src = (FwNodeFilteredSource *)gsrc;
+	HinawaFwNode *self;
+	gint count;
+
+	// The source to read events marks it ready again when forwarding the next event.
+	g_source_set_ready_time(gsrc, -1);
+
+	// The source can be dispatched in the other thread than the one to release the node. The
+	// reference is kept during the dispatch.
+	self = g_weak_ref_get(&src->self);
+	if (self == NULL)
+		return G_SOURCE_REMOVE;
+
+	count = g_async_queue_length(src->queue);
+	while (count-- > 0) {
+		union fw_cdev_event *event = g_async_queue_try_pop(src->queue);
+
+		if (event == NULL)
+			break;
+		dispatch_event(self, event);
+		hinawa_buffer_unref(event);
+	}
+
+	g_object_unref(self);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void finalize_filtered_src(GSource *gsrc)
+{
+	FwNodeFilteredSource *src = (FwNodeFilteredSource *)gsrc;
+
+	g_weak_ref_clear(&src->self);
+	g_async_queue_unref(src->queue);
+}
+
+/**
+ * hinawa_fw_node_create_filtered_source:
+ * @self: A [class@FwNode].
+ * @classes: The set of classes of event in [flags@FwNodeEventClass] dispatched by the source.
+ * @gsrc: (out): A [struct@GLib.Source].
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
+ *
+ * Create [struct@GLib.Source] to dispatch the classes of events apart from the source retrieved
+ * by [method@FwNode.create_source] or the thread launched by [method@FwNode.launch_dispatcher].
+ * The source does not read events from the node. The source to read them forwards the events in
+ * the classes to the source, thus both sources should be available. Each source can be attached
+ * to [struct@GLib.MainContext] running in different thread so that handlers for the request to
+ * [class@FwResp] do not delay the completion of transactions for [class@FwReq], for example. When
+ * several sources are for the same class, the source created earlier receives the events. The
+ * source does not keep the node, and is destroyed when the node is released.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_node_create_filtered_source(HinawaFwNode *self,
+					       HinawaFwNodeEventClass classes, GSource **gsrc,
+					       GError **error)
+{
+	static GSourceFuncs funcs = {
+		.dispatch	= dispatch_filtered_src,
+		.finalize	= finalize_filtered_src,
+	};
+	HinawaFwNodePrivate *priv;
+	FwNodeFilteredSource *src;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	g_return_val_if_fail(classes != 0, FALSE);
+	g_return_val_if_fail(gsrc != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	if (priv->fd < 0) {
+		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+		return FALSE;
+	}
+
+	*gsrc = g_source_new(&funcs, sizeof(FwNodeFilteredSource));
+	src = (FwNodeFilteredSource *)(*gsrc);
+
+	g_source_set_name(*gsrc, "HinawaFwNodeFiltered");
+
+	// The list of node owns the reference of source, thus the source refers to the node
+	// weakly.
+	g_weak_ref_init(&src->self, self);
+	src->classes = classes;
+	src->queue = g_async_queue_new_full(hinawa_buffer_unref);
+
+	// The list owns the reference till the source is destroyed.
+	g_mutex_lock(&priv->filters_mutex);
+	g_ptr_array_add(priv->filters, g_source_ref(*gsrc));
+	g_atomic_int_set(&priv->filter_count, priv->filters->len);
+	g_mutex_unlock(&priv->filters_mutex);
+
+	return TRUE;
+}
+
+struct dispatcher {
+	HinawaFwNode *node;
+	GThread *thread;
+	int notifier;
+
+	gint sched_priority;
+	gint cpu;
+
+	GMutex mutex;
+	GCond cond;
+	gboolean ready;
+	GError *error;
+
+	// Accessed only in the thread.
+	gboolean finished;
+	gboolean detached;
+
+	// Set atomically when the thread leaves the loop by itself or by the request.
+	gint exited;
+};
+
+static void free_dispatcher(struct dispatcher *d)
+{
+	close(d->notifier);
+	g_cond_clear(&d->cond);
+	g_mutex_clear(&d->mutex);
+	g_free(d);
+}
+
+static gboolean configure_dispatcher_thread(struct dispatcher *d, GError **error)
+{
+	int err;
+
+	if (d->cpu >= 0) {
+		cpu_set_t cpus;
+
+		CPU_ZERO(&cpus);
+		CPU_SET(d->cpu, &cpus);
+		err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (err > 0) {
+			generate_syscall_error(error, err, "pthread_setaffinity_np(%d)", d->cpu);
+			return FALSE;
+		}
+	}
+
+	if (d->sched_priority > 0) {
+		struct sched_param param = {
+			.sched_priority = d->sched_priority,
+		};
+
+		err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (err > 0) {
+			generate_syscall_error(error, err, "pthread_setschedparam(%s)", "SCHED_FIFO");
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gpointer run_dispatcher(gpointer data)
+{
+	struct dispatcher *d = data;
+	HinawaFwNodePrivate *priv = hinawa_fw_node_get_instance_private(d->node);
+	HinawaFwNode *node;
+	struct pollfd pfds[2];
+	GIOCondition condition;
+	gboolean result;
+
+	result = configure_dispatcher_thread(d, &d->error);
+
+	g_mutex_lock(&d->mutex);
+	d->ready = TRUE;
+	g_cond_signal(&d->cond);
+	g_mutex_unlock(&d->mutex);
+
+	if (!result)
+		return NULL;
+
+	pfds[0].fd = priv->fd;
+	pfds[0].events = POLLIN;
+	pfds[1].fd = d->notifier;
+	pfds[1].events = POLLIN;
+
+	while (TRUE) {
+		if (poll(pfds, G_N_ELEMENTS(pfds), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		// Requested to terminate.
+		if (pfds[1].revents & POLLIN)
+			break;
+
+		condition = 0;
+		if (pfds[0].revents & POLLIN)
+			condition |= G_IO_IN;
+		if (pfds[0].revents & POLLERR)
+			condition |= G_IO_ERR;
+		if (pfds[0].revents & POLLHUP)
+			condition |= G_IO_HUP;
+
+		if (!hinawa_fw_node_dispatch(d->node, condition))
+			break;
+	}
+
+	g_atomic_int_set(&d->exited, TRUE);
+
+	// The dispatcher is released in the thread when terminated by any handler in the thread.
+	// Else the node can be finalized in the thread by the release of reference below, then
+	// the dispatcher is released by the finalization.
+	node = d->node;
+	d->finished = TRUE;
+	if (d->detached)
+		free_dispatcher(d);
+	g_object_unref(node);
+
+	return NULL;
+}
+
+/**
+ * hinawa_fw_node_launch_dispatcher:
+ * @self: A [class@FwNode].
+ * @sched_priority: The priority of SCHED_FIFO scheduling policy for the thread. When the value is
+ *		    0, the thread inherits the scheduling policy of the caller.
+ * @cpu: The numeric ID of processor to which the thread is bound. When the value is negative, the
+ *	 thread is not bound to any processor.
+ * @error: A [struct@GLib.Error]. Error can be generated with domain of [error@FwNodeError].
+ *
+ * Launch the thread dedicated to dispatch events for the node on IEEE 1394 bus, as an alternative
+ * of [struct@GLib.Source] retrieved by [method@FwNode.create_source]. The thread waits for events
+ * by `poll(2)` and process them within the budget configured by
+ * [property@FwNode:dispatch-event-budget] and [property@FwNode:dispatch-time-budget]. Any signal
+ * is emitted in the context of thread. The source should not be used at the same time.
+ *
+ * The thread is terminated by [method@FwNode.terminate_dispatcher], or when the node is
+ * disconnected. The thread keeps a reference to the node while running, thus the function
+ * should be called before releasing the node unless the node is disconnected. When the thread
+ * has exited by itself, the function launches a new thread after reaping the former one.
+ *
+ * Returns: TRUE if the overall operation finishes successfully, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_node_launch_dispatcher(HinawaFwNode *self, gint sched_priority, gint cpu,
+					  GError **error)
+{
+	HinawaFwNodePrivate *priv;
+	struct dispatcher *d;
+
+	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), FALSE);
+	g_return_val_if_fail(sched_priority >= 0, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	priv = hinawa_fw_node_get_instance_private(self);
+	if (priv->fd < 0) {
+		generate_local_error(error, HINAWA_FW_NODE_ERROR_NOT_OPENED);
+		return FALSE;
+	}
+
+	// The thread exits by itself at disconnection or error of poll(2).
+	if (priv->dispatcher != NULL && g_atomic_int_get(&priv->dispatcher->exited))
+		hinawa_fw_node_terminate_dispatcher(self);
+
+	if (priv->dispatcher != NULL) {
+		g_set_error_literal(error, HINAWA_FW_NODE_ERROR, HINAWA_FW_NODE_ERROR_FAILED,
+				    "The dispatcher is already launched");
+		return FALSE;
+	}
+
+	d = g_malloc0(sizeof(*d));
+	// The reference is released by the thread when finishing.
+	d->node = g_object_ref(self);
+	d->sched_priority = sched_priority;
+	d->cpu = cpu;
+	g_mutex_init(&d->mutex);
+	g_cond_init(&d->cond);
+
+	d->notifier = eventfd(0, EFD_CLOEXEC);
+	if (d->notifier < 0) {
+		generate_syscall_error(error, errno, "eventfd(%s)", "EFD_CLOEXEC");
+		goto err_free;
+	}
+
+	d->thread = g_thread_try_new("HinawaFwNode", run_dispatcher, d, error);
+	if (d->thread == NULL)
+		goto err_close;
+
+	// Wait for the thread to be configured.
+	g_mutex_lock(&d->mutex);
+	while (!d->ready)
+		g_cond_wait(&d->cond, &d->mutex);
+	g_mutex_unlock(&d->mutex);
+
+	if (d->error != NULL) {
+		g_thread_join(d->thread);
+		g_propagate_error(error, d->error);
+		goto err_close;
+	}
+
+	priv->dispatcher = d;
+
+	return TRUE;
+err_close:
+	close(d->notifier);
+err_free:
+	g_object_unref(d->node);
+	g_cond_clear(&d->cond);
+	g_mutex_clear(&d->mutex);
+	g_free(d);
+
+	return FALSE;
+}
+
+/**
+ * hinawa_fw_node_terminate_dispatcher:
+ * @self: A [class@FwNode].
+ *
+ * Terminate the thread launched by [method@FwNode.launch_dispatcher] and wait for the thread to
+ * finish. Nothing happens when the thread is not launched. When called in any signal handler
+ * emitted by the thread, the function requests the thread to finish without waiting.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_node_terminate_dispatcher(HinawaFwNode *self)
+{
+	HinawaFwNodePrivate *priv;
+	struct dispatcher *d;
+	guint64 val = 1;
+
+	g_return_if_fail(HINAWA_IS_FW_NODE(self));
+	priv = hinawa_fw_node_get_instance_private(self);
+
+	d = priv->dispatcher;
+	if (d == NULL)
+		return;
+	priv->dispatcher = NULL;
+
+	// The thread may already finish due to disconnection, thus ignore the result.
+	(void)!write(d->notifier, &val, sizeof(val));
+
+	// In the thread, by any handler or by the finalization at the release of reference.
+	if (g_thread_self() == d->thread) {
+		g_thread_unref(d->thread);
+		if (d->finished)
+			free_dispatcher(d);
+		else
+			d->detached = TRUE;
+		return;
+	}
+
+	g_thread_join(d->thread);
+	free_dispatcher(d);
+}
+
 // Internal use only.
 int hinawa_fw_node_ioctl(HinawaFwNode *self, unsigned long req, void *args, GError **error)
 {
 	HinawaFwNodePrivate *priv;
+	HinawaFwReq *transaction = NULL;
+	guint nr = _IOC_NR(req);
 
 	g_return_val_if_fail(HINAWA_IS_FW_NODE(self), ENXIO);
 	g_return_val_if_fail(error != NULL, EINVAL);
@@ -658,14 +2486,39 @@ int hinawa_fw_node_ioctl(HinawaFwNode *self, unsigned long req, void *args, GErr
 	// To invalidate the transaction in a case of timeout.
 	if (req == FW_CDEV_IOC_SEND_REQUEST) {
 		struct fw_cdev_send_request *data = args;
-		HinawaFwReq *req = (HinawaFwReq *)data->closure;
-		priv->transactions = g_list_prepend(priv->transactions, req);
+		enum hinawa_closure_kind kind;
+		struct hinawa_fw_req_transaction *entry;
+
+		transaction = hinawa_closure_lookup(data->closure, &kind);
+		g_return_val_if_fail(transaction != NULL, EINVAL);
+		g_return_val_if_fail(kind == HINAWA_CLOSURE_KIND_FW_REQ, EINVAL);
+
+		// The table owns the reference till the transaction finishes. The value is the
+		// storage in the instance for the time to issue the request for the statistics of
+		// round trip, and the generation to distinguish the stale transactions at bus reset.
+		entry = hinawa_fw_req_get_transaction(transaction);
+		g_mutex_lock(&priv->transactions_mutex);
+		entry->issued = g_get_monotonic_time();
+		entry->generation = data->generation;
+		g_hash_table_insert(priv->transactions, transaction, entry);
+		g_mutex_unlock(&priv->transactions_mutex);
 	}
 
-	if (ioctl(priv->fd, req, args) < 0) {
-		if (errno == ENODEV)
+	if (nr < HINAWA_FW_NODE_STATS_IOCTL_CODES)
+		stats_add(priv->stats.ioctl_calls[nr], 1);
+
+	if (priv->backend->ioctl(priv->fd, req, args, priv->backend_data) < 0) {
+		int err = errno;
+
+		if (nr < HINAWA_FW_NODE_STATS_IOCTL_CODES)
+			stats_add(priv->stats.ioctl_errors[nr], 1);
+
+		if (transaction != NULL)
+			hinawa_fw_node_invalidate_transaction(self, transaction);
+
+		if (err == ENODEV)
 			generate_local_error(error, HINAWA_FW_NODE_ERROR_DISCONNECTED);
-		return errno;
+		return err;
 	}
 
 	return 0;
@@ -674,16 +2527,11 @@ int hinawa_fw_node_ioctl(HinawaFwNode *self, unsigned long req, void *args, GErr
 void hinawa_fw_node_invalidate_transaction(HinawaFwNode *self, HinawaFwReq *req)
 {
 	HinawaFwNodePrivate *priv;
-	GList *entry;
 
 	g_return_if_fail(HINAWA_IS_FW_NODE(self));
 	priv = hinawa_fw_node_get_instance_private(self);
 
 	g_mutex_lock(&priv->transactions_mutex);
-	entry = g_list_find(priv->transactions, req);
-	if (entry) {
-		priv->transactions =
-				g_list_delete_link(priv->transactions, entry);
-	}
+	g_hash_table_remove(priv->transactions, req);
 	g_mutex_unlock(&priv->transactions_mutex);
 }
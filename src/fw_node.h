@@ -14,6 +14,71 @@ G_DECLARE_DERIVABLE_TYPE(HinawaFwNode, hinawa_fw_node, HINAWA, FW_NODE, GObject)
 
 GQuark hinawa_fw_node_error_quark();
 
+#define HINAWA_TYPE_FW_NODE_TRACE_ENTRY	(hinawa_fw_node_trace_entry_get_type())
+
+/**
+ * HinawaFwNodeTraceEntry:
+ * @event_type: The type of event in UAPI of Linux FireWire subsystem.
+ * @closure_kind: The kind of instance for the event; 1 for [class@FwNode], 2 for [class@FwResp],
+ *		  3 for [class@FwReq], and 0 for the instance released already.
+ * @length: The length of payload for the event.
+ * @tstamp: The time stamp of packet for the event, or G_MAXUINT if unavailable.
+ * @monotonic_time: The value of monotonic time when the event is read.
+ *
+ * An entry of ring to trace events.
+ *
+ * Since: 4.1
+ */
+typedef struct {
+	guint32 event_type;
+	guint32 closure_kind;
+	guint32 length;
+	guint32 tstamp;
+	gint64 monotonic_time;
+} HinawaFwNodeTraceEntry;
+
+GType hinawa_fw_node_trace_entry_get_type() G_GNUC_CONST;
+
+HinawaFwNodeTraceEntry *hinawa_fw_node_trace_entry_copy(const HinawaFwNodeTraceEntry *self);
+
+#define HINAWA_TYPE_FW_NODE_STATS	(hinawa_fw_node_stats_get_type())
+
+#define HINAWA_FW_NODE_STATS_EVENT_TYPES	16
+#define HINAWA_FW_NODE_STATS_IOCTL_CODES	32
+#define HINAWA_FW_NODE_STATS_BUCKETS		24
+
+/**
+ * HinawaFwNodeStats:
+ * @events: The number of events read, indexed by the type of event in UAPI of Linux FireWire
+ *	    subsystem.
+ * @bytes_read: The total number of bytes read from the character device.
+ * @ioctl_calls: The number of ioctl calls, indexed by the number of request code.
+ * @ioctl_errors: The number of failed ioctl calls, indexed by the number of request code.
+ * @transactions_in_flight: The number of transactions waiting for response.
+ * @dispatch_latency: The histogram of time to dispatch events at each wakeup. The bucket n
+ *		      counts the duration less than 2^(n + 1) microseconds and the last bucket
+ *		      counts the rest.
+ * @round_trip_time: The histogram of time from the request of transaction to the response,
+ *		     bucketed in the same way as @dispatch_latency.
+ *
+ * A snapshot of counters for performance of [class@FwNode].
+ *
+ * Since: 4.1
+ */
+typedef struct {
+	guint64 events[HINAWA_FW_NODE_STATS_EVENT_TYPES];
+	guint64 bytes_read;
+	guint64 ioctl_calls[HINAWA_FW_NODE_STATS_IOCTL_CODES];
+	guint64 ioctl_errors[HINAWA_FW_NODE_STATS_IOCTL_CODES];
+	guint64 transactions_in_flight;
+	guint64 dispatch_latency[HINAWA_FW_NODE_STATS_BUCKETS];
+	guint64 round_trip_time[HINAWA_FW_NODE_STATS_BUCKETS];
+} HinawaFwNodeStats;
+
+GType hinawa_fw_node_stats_get_type() G_GNUC_CONST;
+
+HinawaFwNodeStats *hinawa_fw_node_stats_copy(const HinawaFwNodeStats *self);
+
 struct _HinawaFwNodeClass {
 	GObjectClass parent_class;
 
@@ -39,18 +104,58 @@ struct _HinawaFwNodeClass {
 
 };
 
+/**
+ * HinawaFwNodeBusUpdateFunc:
+ * @self: A [class@FwNode].
+ * @user_data: The data given to [method@FwNode.set_bus_update_func].
+ *
+ * The function called with the same arguments as [signal@FwNode::bus-update].
+ *
+ * Since: 4.1
+ */
+typedef void (*HinawaFwNodeBusUpdateFunc)(HinawaFwNode *self, gpointer user_data);
+
 HinawaFwNode *hinawa_fw_node_new(void);
 
 gboolean hinawa_fw_node_open(HinawaFwNode *self, const gchar *path, gint open_flag, GError **error);
 
+gboolean hinawa_fw_node_open_bulk(const gchar *const *paths, gint open_flag, guint max_workers,
+				  GPtrArray **nodes, GPtrArray **errors, GError **error);
+
+void hinawa_fw_node_get_bus_state(HinawaFwNode *self, guint *generation, guint *node_id,
+				  guint *local_node_id, guint *bus_manager_node_id,
+				  guint *ir_manager_node_id, guint *root_node_id, guint *card_id);
+
 gboolean hinawa_fw_node_get_config_rom(HinawaFwNode *self, const guint8 **image, gsize *length,
 				       GError **error);
 
+gboolean hinawa_fw_node_get_config_rom_bytes(HinawaFwNode *self, GBytes **bytes, GError **error);
+
+gboolean hinawa_fw_node_get_config_rom_index(HinawaFwNode *self, HinawaConfigRom **index,
+					     GError **error);
+
 gboolean hinawa_fw_node_read_cycle_time(HinawaFwNode *self, gint clock_id,
 					HinawaCycleTime **cycle_time, GError **error);
 
 gboolean hinawa_fw_node_create_source(HinawaFwNode *self, GSource **gsrc, GError **error);
 
+gboolean hinawa_fw_node_launch_dispatcher(HinawaFwNode *self, gint sched_priority, gint cpu,
+					  GError **error);
+
+void hinawa_fw_node_terminate_dispatcher(HinawaFwNode *self);
+
+void hinawa_fw_node_dump_trace(HinawaFwNode *self, HinawaFwNodeTraceEntry **entries,
+			       gsize *count);
+
+void hinawa_fw_node_get_stats(HinawaFwNode *self, HinawaFwNodeStats **stats);
+
+gboolean hinawa_fw_node_create_filtered_source(HinawaFwNode *self,
+					       HinawaFwNodeEventClass classes, GSource **gsrc,
+					       GError **error);
+
+void hinawa_fw_node_set_bus_update_func(HinawaFwNode *self, HinawaFwNodeBusUpdateFunc func,
+					gpointer user_data, GDestroyNotify notify);
+
 G_END_DECLS
 
 #endif
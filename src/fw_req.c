@@ -23,7 +23,36 @@
  */
 G_DEFINE_QUARK(hinawa-fw-req-error-quark, hinawa_fw_req_error)
 
-G_DEFINE_TYPE(HinawaFwReq, hinawa_fw_req, G_TYPE_OBJECT)
+typedef struct {
+	guint64 closure;
+	gboolean reissue;
+
+	// The parameters of transaction in flight, kept to reissue it after bus reset. They are
+	// protected by the mutex. The buffer for payload is reused for the next transaction.
+	gboolean saved;
+	HinawaFwTcode tcode;
+	guint64 addr;
+	gsize length;
+	guint8 *payload;
+	gsize payload_size;
+
+	// The time to issue and the generation, used by the node.
+	struct hinawa_fw_req_transaction transaction;
+
+	// The event in the buffer of node, available during emission of the signal.
+	gconstpointer event;
+	const guint8 *frame;
+	gsize frame_size;
+
+	// The functions called without emission of signal. They are called without the lock. The
+	// waiter is taken at the response, and released after the call.
+	GMutex mutex;
+	struct hinawa_callback *responded_cb;
+	struct waiter *waiter;
+	gboolean waiter_busy;
+	GCond waiter_cond;
+} HinawaFwReqPrivate;
+G_DEFINE_TYPE_WITH_PRIVATE(HinawaFwReq, hinawa_fw_req, G_TYPE_OBJECT)
 
 static const char *const err_labels[] = {
 	[HINAWA_FW_REQ_ERROR_CONFLICT_ERROR]	= "conflict error",
@@ -49,14 +78,107 @@ static void generate_fw_req_error_literal(GError **error, HinawaFwReqError code)
 	g_set_error_literal(error, HINAWA_FW_REQ_ERROR, code, err_labels[code]);
 }
 
+enum fw_req_prop_type {
+	FW_REQ_PROP_TYPE_REISSUE = 1,
+	FW_REQ_PROP_TYPE_COUNT,
+};
+static GParamSpec *fw_req_props[FW_REQ_PROP_TYPE_COUNT] = { NULL, };
+
 enum fw_req_sig_type {
 	FW_REQ_SIG_TYPE_RESPONDED = 0,
 	FW_REQ_SIG_TYPE_COUNT,
 };
 static guint fw_req_sigs[FW_REQ_SIG_TYPE_COUNT] = { 0 };
 
+static void fw_req_get_property(GObject *obj, guint id, GValue *val, GParamSpec *spec)
+{
+	HinawaFwReq *self = HINAWA_FW_REQ(obj);
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+
+	switch (id) {
+	case FW_REQ_PROP_TYPE_REISSUE:
+		g_value_set_boolean(val, priv->reissue);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, id, spec);
+		break;
+	}
+}
+
+static void fw_req_set_property(GObject *obj, guint id, const GValue *val, GParamSpec *spec)
+{
+	HinawaFwReq *self = HINAWA_FW_REQ(obj);
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+
+	switch (id) {
+	case FW_REQ_PROP_TYPE_REISSUE:
+		priv->reissue = g_value_get_boolean(val);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, id, spec);
+		break;
+	}
+}
+
+static void fw_req_dispose(GObject *obj)
+{
+	HinawaFwReq *self = HINAWA_FW_REQ(obj);
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+
+	// The completion event delivered after this point is rejected by the registry.
+	if (priv->closure > 0) {
+		hinawa_closure_unregister(priv->closure);
+		priv->closure = 0;
+	}
+
+	G_OBJECT_CLASS(hinawa_fw_req_parent_class)->dispose(obj);
+}
+
+static void fw_req_finalize(GObject *obj)
+{
+	HinawaFwReq *self = HINAWA_FW_REQ(obj);
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+
+	g_free(priv->payload);
+
+	if (priv->responded_cb != NULL)
+		hinawa_callback_unref(priv->responded_cb);
+	g_cond_clear(&priv->waiter_cond);
+	g_mutex_clear(&priv->mutex);
+
+	G_OBJECT_CLASS(hinawa_fw_req_parent_class)->finalize(obj);
+}
+
 static void hinawa_fw_req_class_init(HinawaFwReqClass *klass)
 {
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+	gobject_class->get_property = fw_req_get_property;
+	gobject_class->set_property = fw_req_set_property;
+	gobject_class->dispose = fw_req_dispose;
+	gobject_class->finalize = fw_req_finalize;
+
+	/**
+	 * HinawaFwReq:reissue:
+	 *
+	 * Whether to reissue the transaction in flight at the new generation of bus topology when
+	 * bus reset occurs. When disabled, the transaction in flight is finished immediately with
+	 * [enum@FwRcode].GENERATION at bus reset.
+	 *
+	 * The content of request subaction is copied at the request when enabled. It should be
+	 * enabled just for idempotent transactions, since the request subaction may have already
+	 * arrived at the node before bus reset.
+	 *
+	 * Since: 4.1
+	 */
+	fw_req_props[FW_REQ_PROP_TYPE_REISSUE] =
+		g_param_spec_boolean("reissue", "reissue",
+				     "Whether to reissue the transaction in flight at bus reset",
+				     FALSE,
+				     G_PARAM_READWRITE);
+
+	g_object_class_install_properties(gobject_class, FW_REQ_PROP_TYPE_COUNT, fw_req_props);
+
 	/**
 	 * HinawaFwReq::responded:
 	 * @self: A [class@FwReq].
@@ -80,6 +202,16 @@ static void hinawa_fw_req_class_init(HinawaFwReqClass *klass)
 	 * If the version of kernel ABI for Linux FireWire subsystem is less than 6, the
 	 * @request_tstamp and @response_tstamp argument has invalid value (=G_MAXUINT).
 	 *
+	 * When bus reset occurs while the transaction is in flight, the signal is emitted
+	 * immediately with [enum@FwRcode].GENERATION for @rcode unless [property@FwReq:reissue] is
+	 * enabled.
+	 *
+	 * The @frame is available only during the emission. The handler can retrieve it by
+	 * [method@FwReq.get_frame_bytes] to keep it without copying.
+	 *
+	 * The signal is not emitted when the function is set by [method@FwReq.set_responded_func]
+	 * and no handler is connected.
+	 *
 	 * Since: 4.0
 	 */
 	fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED] =
@@ -92,11 +224,18 @@ static void hinawa_fw_req_class_init(HinawaFwReqClass *klass)
 			     G_TYPE_NONE,
 			     5, HINAWA_TYPE_FW_RCODE, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_POINTER,
 			     G_TYPE_UINT);
+	g_signal_set_va_marshaller(fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED],
+				   G_OBJECT_CLASS_TYPE(klass),
+				   hinawa_sigs_marshal_VOID__ENUM_UINT_UINT_POINTER_UINTv);
 }
 
 static void hinawa_fw_req_init(HinawaFwReq *self)
 {
-	return;
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+
+	priv->closure = hinawa_closure_register(HINAWA_CLOSURE_KIND_FW_REQ, self);
+	g_mutex_init(&priv->mutex);
+	g_cond_init(&priv->waiter_cond);
 }
 
 /**
@@ -112,6 +251,39 @@ HinawaFwReq *hinawa_fw_req_new(void)
 	return g_object_new(HINAWA_TYPE_FW_REQ, NULL);
 }
 
+static gboolean send_request(HinawaFwReq *self, HinawaFwNode *node, HinawaFwTcode tcode,
+			     guint64 addr, gsize length, const guint8 *data, GError **error)
+{
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+	struct fw_cdev_send_request req = {0};
+	guint generation;
+	int err;
+
+	// The completion of transaction issued previously is rejected by the new handle.
+	priv->closure = hinawa_closure_renew(priv->closure);
+
+	hinawa_fw_node_get_bus_state(node, &generation, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	// Setup a transaction structure.
+	req.tcode = tcode;
+	req.length = length;
+	req.offset = addr;
+	req.closure = priv->closure;
+	req.generation = generation;
+
+	if (tcode != TCODE_READ_QUADLET_REQUEST && tcode != TCODE_READ_BLOCK_REQUEST)
+		req.data = (guint64)data;
+
+	HINAWA_PROBE5(transaction_submit, self, tcode, addr, length, generation);
+
+	// Send this transaction.
+	err = hinawa_fw_node_ioctl(node, FW_CDEV_IOC_SEND_REQUEST, &req, error);
+	if (*error == NULL && err > 0)
+		generate_fw_req_error_with_errno(error, HINAWA_FW_REQ_ERROR_SEND_ERROR, err);
+
+	return err >= 0;
+}
+
 /**
  * hinawa_fw_req_request:
  * @self: A [class@FwReq].
@@ -139,9 +311,7 @@ gboolean hinawa_fw_req_request(HinawaFwReq *self, HinawaFwNode *node, HinawaFwTc
 			       guint64 addr, gsize length, guint8 **frame, gsize *frame_size,
 			       GError **error)
 {
-	struct fw_cdev_send_request req = {0};
-	guint generation;
-	int err;
+	HinawaFwReqPrivate *priv;
 
 	g_return_val_if_fail(HINAWA_IS_FW_REQ(self), FALSE);
 	g_return_val_if_fail(HINAWA_IS_FW_NODE(node), FALSE);
@@ -182,25 +352,144 @@ gboolean hinawa_fw_req_request(HinawaFwReq *self, HinawaFwNode *node, HinawaFwTc
 		g_return_val_if_reached(FALSE);
 	}
 
-	// Get node property.
-	g_object_get(G_OBJECT(node), "generation", &generation, NULL);
+	priv = hinawa_fw_req_get_instance_private(self);
+
+	g_mutex_lock(&priv->mutex);
+	priv->saved = priv->reissue;
+	if (priv->saved) {
+		priv->tcode = tcode;
+		priv->addr = addr;
+		priv->length = length;
+		if (tcode != TCODE_READ_QUADLET_REQUEST && tcode != TCODE_READ_BLOCK_REQUEST) {
+			if (priv->payload_size < length) {
+				priv->payload = g_realloc(priv->payload, length);
+				priv->payload_size = length;
+			}
+			memcpy(priv->payload, *frame, length);
+		}
+	}
+	g_mutex_unlock(&priv->mutex);
 
-	// Setup a transaction structure.
-	req.tcode = tcode;
-	req.length = length;
-	req.offset = addr;
-	req.closure = (guint64)self;
-	req.generation = generation;
+	return send_request(self, node, tcode, addr, length, *frame, error);
+}
 
-	if (tcode != TCODE_READ_QUADLET_REQUEST && tcode != TCODE_READ_BLOCK_REQUEST)
-		req.data = (guint64)(*frame);
+static void handle_responded_signal(HinawaFwReq *self, HinawaFwRcode rcode, guint request_tstamp,
+				    guint response_tstamp, const guint8 *frame, guint frame_size,
+				    gpointer user_data);
 
-	// Send this transaction.
-	err = hinawa_fw_node_ioctl(node, FW_CDEV_IOC_SEND_REQUEST, &req, error);
-	if (*error == NULL && err > 0)
-		generate_fw_req_error_with_errno(error, HINAWA_FW_REQ_ERROR_SEND_ERROR, err);
+// The functions are called at first, then the signal is emitted just for connected handlers or
+// the class closure.
+static void emit_responded(HinawaFwReq *self, gconstpointer event, guint rcode,
+			   guint request_tstamp, guint response_tstamp, const guint8 *frame,
+			   gsize frame_size)
+{
+	HinawaFwReqPrivate *priv = hinawa_fw_req_get_instance_private(self);
+	HinawaFwReqClass *klass = HINAWA_FW_REQ_GET_CLASS(self);
+	struct hinawa_callback *cb;
+	struct waiter *waiter;
+	gboolean direct;
+
+	priv->event = event;
+	priv->frame = frame;
+	priv->frame_size = frame_size;
+
+	// The waiter is just for one response.
+	g_mutex_lock(&priv->mutex);
+	waiter = priv->waiter;
+	if (waiter != NULL) {
+		priv->waiter = NULL;
+		priv->waiter_busy = TRUE;
+	}
+	cb = priv->responded_cb;
+	if (cb != NULL)
+		hinawa_callback_ref(cb);
+	g_mutex_unlock(&priv->mutex);
+
+	if (waiter != NULL) {
+		handle_responded_signal(self, rcode, request_tstamp, response_tstamp, frame,
+					frame_size, waiter);
+
+		g_mutex_lock(&priv->mutex);
+		priv->waiter_busy = FALSE;
+		g_cond_broadcast(&priv->waiter_cond);
+		g_mutex_unlock(&priv->mutex);
+	}
 
-	return err >= 0;
+	if (cb != NULL) {
+		((HinawaFwReqRespondedFunc)cb->func)(self, rcode, request_tstamp, response_tstamp,
+						     frame, frame_size, cb->data);
+		hinawa_callback_unref(cb);
+	}
+
+	direct = waiter != NULL || cb != NULL;
+
+	if (g_signal_has_handler_pending(self, fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED], 0, FALSE)) {
+		g_signal_emit(self, fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED], 0, rcode,
+			      request_tstamp, response_tstamp, frame, frame_size);
+	} else if (klass->responded != NULL) {
+		klass->responded(self, rcode, request_tstamp, response_tstamp, frame, frame_size);
+	} else if (!direct) {
+		g_signal_emit(self, fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED], 0, rcode,
+			      request_tstamp, response_tstamp, frame, frame_size);
+	}
+
+	priv->event = NULL;
+	priv->frame = NULL;
+	priv->frame_size = 0;
+}
+
+// NOTE: For HinawaFwNode, internal. The storage is embedded in the instance so that no memory is
+// allocated for each transaction.
+struct hinawa_fw_req_transaction *hinawa_fw_req_get_transaction(HinawaFwReq *self)
+{
+	HinawaFwReqPrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_REQ(self), NULL);
+	priv = hinawa_fw_req_get_instance_private(self);
+
+	return &priv->transaction;
+}
+
+// NOTE: For HinawaFwNode, internal. The transaction in flight is already removed from the node.
+void hinawa_fw_req_handle_bus_reset(HinawaFwReq *self, HinawaFwNode *node)
+{
+	HinawaFwReqPrivate *priv;
+	HinawaFwTcode tcode = 0;
+	guint64 addr = 0;
+	gsize length = 0;
+	guint8 *payload = NULL;
+	gboolean saved;
+
+	g_return_if_fail(HINAWA_IS_FW_REQ(self));
+	priv = hinawa_fw_req_get_instance_private(self);
+
+	// Take a snapshot of the request since the other thread can issue the next one. It is rare
+	// to reissue, thus the payload is copied here.
+	g_mutex_lock(&priv->mutex);
+	saved = priv->saved;
+	if (saved) {
+		tcode = priv->tcode;
+		addr = priv->addr;
+		length = priv->length;
+		if (tcode != TCODE_READ_QUADLET_REQUEST && tcode != TCODE_READ_BLOCK_REQUEST) {
+			payload = g_malloc(length);
+			memcpy(payload, priv->payload, length);
+		}
+	}
+	g_mutex_unlock(&priv->mutex);
+
+	if (saved) {
+		GError *error = NULL;
+		gboolean result;
+
+		result = send_request(self, node, tcode, addr, length, payload, &error);
+		g_free(payload);
+		if (result)
+			return;
+		g_clear_error(&error);
+	}
+
+	emit_responded(self, NULL, RCODE_GENERATION, G_MAXUINT, G_MAXUINT, NULL, 0);
 }
 
 struct waiter {
@@ -274,13 +563,14 @@ gboolean hinawa_fw_req_transaction_with_tstamp(HinawaFwReq *self, HinawaFwNode *
 					       guint8 **frame, gsize *frame_size, guint tstamp[2],
 					       guint timeout_ms, GError **error)
 {
+	HinawaFwReqPrivate *priv;
 	struct waiter w;
-	gulong handler_id;
 	guint64 expiration;
 
 	g_return_val_if_fail(HINAWA_IS_FW_REQ(self), FALSE);
 	g_return_val_if_fail(HINAWA_IS_FW_NODE(node), FALSE);
 	g_return_val_if_fail(tstamp != NULL, FALSE);
+	priv = hinawa_fw_req_get_instance_private(self);
 
 	// This predicates against suprious wakeup.
 	w.rcode = G_MAXUINT;
@@ -291,14 +581,21 @@ gboolean hinawa_fw_req_transaction_with_tstamp(HinawaFwReq *self, HinawaFwNode *
 	g_cond_init(&w.cond);
 	g_mutex_init(&w.mutex);
 
-        handler_id = g_signal_connect(self, "responded", G_CALLBACK(handle_responded_signal), &w);
+	// The waiter is called directly at the response.
+	g_mutex_lock(&priv->mutex);
+	priv->waiter = &w;
+	g_mutex_unlock(&priv->mutex);
 
 	// Timeout is set in advance as a parameter of this object.
 	expiration = g_get_monotonic_time() + timeout_ms * G_TIME_SPAN_MILLISECOND;
 
 	g_object_ref(node);
 	if (!hinawa_fw_req_request(self, node, tcode, addr, length, frame, frame_size, error)) {
-		g_signal_handler_disconnect(self, handler_id);
+		g_mutex_lock(&priv->mutex);
+		priv->waiter = NULL;
+		while (priv->waiter_busy)
+			g_cond_wait(&priv->waiter_cond, &priv->mutex);
+		g_mutex_unlock(&priv->mutex);
 		g_object_unref(node);
 		return FALSE;
 	}
@@ -309,10 +606,16 @@ gboolean hinawa_fw_req_transaction_with_tstamp(HinawaFwReq *self, HinawaFwNode *
 		if (!g_cond_wait_until(&w.cond, &w.mutex, expiration))
 			break;
 	}
-	g_signal_handler_disconnect(self, handler_id);
-	g_cond_clear(&w.cond);
 	g_mutex_unlock(&w.mutex);
 
+	// Wait for the call of waiter in progress.
+	g_mutex_lock(&priv->mutex);
+	priv->waiter = NULL;
+	while (priv->waiter_busy)
+		g_cond_wait(&priv->waiter_cond, &priv->mutex);
+	g_mutex_unlock(&priv->mutex);
+	g_cond_clear(&w.cond);
+
 	// Always for safe.
 	hinawa_fw_node_invalidate_transaction(node, self);
 	g_object_unref(node);
@@ -384,20 +687,87 @@ gboolean hinawa_fw_req_transaction(HinawaFwReq *self, HinawaFwNode *node,
 						     frame, frame_size, tstamp, timeout_ms, error);
 }
 
-// NOTE: For HinawaFwNode, internal.
+/**
+ * hinawa_fw_req_get_frame_bytes:
+ * @self: A [class@FwReq].
+ * @frame: (out)(transfer full)(nullable): The [struct@GLib.Bytes] for byte data of response
+ *	   subaction.
+ *
+ * Retrieve byte data of response subaction for the transaction as [struct@GLib.Bytes] which
+ * refers to the buffer in which the event was read, instead of copying it. The function is
+ * available only in handlers of [signal@FwReq::responded]. The handler can keep the bytes after
+ * returning, then the buffer is recycled to read the other events once the bytes is released.
+ *
+ * Returns: TRUE if the response subaction is available, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_req_get_frame_bytes(HinawaFwReq *self, GBytes **frame)
+{
+	HinawaFwReqPrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_REQ(self), FALSE);
+	g_return_val_if_fail(frame != NULL, FALSE);
+	priv = hinawa_fw_req_get_instance_private(self);
+
+	if (priv->event == NULL) {
+		*frame = NULL;
+		return FALSE;
+	}
+
+	*frame = hinawa_buffer_slice(priv->event, priv->frame, priv->frame_size);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_req_set_responded_func:
+ * @self: A [class@FwReq].
+ * @func: (scope notified)(closure user_data)(destroy notify)(nullable): The function called
+ *	  when the response subaction arrives, or NULL to unset it.
+ * @user_data: The data passed to @func.
+ * @notify: (nullable): The function called to release @user_data when @func is unset.
+ *
+ * Set the function called with the same arguments as [signal@FwReq::responded], before the
+ * signal is emitted. The function is called directly in the thread to dispatch events, without
+ * boxing the arguments, thus it is suitable for the single consumer of the response. When the
+ * function is set, the signal is emitted only if any handler is connected to the signal or the
+ * class closure is overridden. The function is called without any lock, thus it can issue the
+ * next request or set the other function. The @notify is called after the function is unset
+ * and the call in progress returns.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_req_set_responded_func(HinawaFwReq *self, HinawaFwReqRespondedFunc func,
+				      gpointer user_data, GDestroyNotify notify)
+{
+	HinawaFwReqPrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_REQ(self));
+	priv = hinawa_fw_req_get_instance_private(self);
+
+	hinawa_callback_replace(&priv->responded_cb, &priv->mutex,
+				hinawa_callback_new(G_CALLBACK(func), user_data, notify));
+}
+
+// NOTE: For HinawaFwNode, internal. The event should be in the buffer taken from the pool.
 void hinawa_fw_req_handle_response(HinawaFwReq *self, const struct fw_cdev_event_response *event)
 {
 	g_return_if_fail(HINAWA_IS_FW_REQ(self));
 
-	g_signal_emit(self, fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED], 0, event->rcode, G_MAXUINT,
-		      G_MAXUINT, event->data, event->length);
+	HINAWA_PROBE3(response_matched, self, event->rcode, event->length);
+
+	emit_responded(self, event, event->rcode, G_MAXUINT, G_MAXUINT, (const guint8 *)event->data,
+		       event->length);
 }
 
-// NOTE: For HinawaFwNode, internal.
+// NOTE: For HinawaFwNode, internal. The event should be in the buffer taken from the pool.
 void hinawa_fw_req_handle_response2(HinawaFwReq *self, const struct fw_cdev_event_response2 *event)
 {
 	g_return_if_fail(HINAWA_IS_FW_REQ(self));
 
-	g_signal_emit(self, fw_req_sigs[FW_REQ_SIG_TYPE_RESPONDED], 0, event->rcode,
-		      event->request_tstamp, event->response_tstamp, event->data, event->length);
+	HINAWA_PROBE3(response_matched, self, event->rcode, event->length);
+
+	emit_responded(self, event, event->rcode, event->request_tstamp, event->response_tstamp,
+		       (const guint8 *)event->data, event->length);
 }
@@ -37,6 +37,27 @@ struct _HinawaFwReqClass {
 			  guint response_tstamp, const guint8 *frame, guint frame_size);
 };
 
+/**
+ * HinawaFwReqRespondedFunc:
+ * @self: A [class@FwReq].
+ * @rcode: One of [enum@FwRcode].
+ * @request_tstamp: The isochronous cycle at which the request subaction was sent for the
+ *		    transaction.
+ * @response_tstamp: The isochronous cycle at which the response subaction arrived for the
+ *		     transaction.
+ * @frame: (array length=frame_size)(element-type guint8): The array with elements for byte data
+ *	   of response subaction for the transaction.
+ * @frame_size: The number of elements of the array.
+ * @user_data: The data given to [method@FwReq.set_responded_func].
+ *
+ * The function called with the same arguments as [signal@FwReq::responded].
+ *
+ * Since: 4.1
+ */
+typedef void (*HinawaFwReqRespondedFunc)(HinawaFwReq *self, HinawaFwRcode rcode,
+					 guint request_tstamp, guint response_tstamp,
+					 const guint8 *frame, guint frame_size, gpointer user_data);
+
 HinawaFwReq *hinawa_fw_req_new(void);
 
 gboolean hinawa_fw_req_request(HinawaFwReq *self, HinawaFwNode *node, HinawaFwTcode tcode,
@@ -53,6 +74,11 @@ gboolean hinawa_fw_req_transaction(HinawaFwReq *self, HinawaFwNode *node,
 				   guint8 **frame, gsize *frame_size, guint timeout_ms,
 				   GError **error);
 
+gboolean hinawa_fw_req_get_frame_bytes(HinawaFwReq *self, GBytes **frame);
+
+void hinawa_fw_req_set_responded_func(HinawaFwReq *self, HinawaFwReqRespondedFunc func,
+				      gpointer user_data, GDestroyNotify notify);
+
 G_END_DECLS
 
 #endif
@@ -32,12 +32,13 @@ static const char *const err_msgs[] = {
 #define generate_local_error(error, code) \
 	g_set_error_literal(error, HINAWA_FW_RESP_ERROR, code, err_msgs[code])
 
-#define generate_syscall_error(error, errno, format, arg)			\
+#define generate_resp_syscall_error(error, errno, format, arg)		\
 	g_set_error(error, HINAWA_FW_RESP_ERROR, HINAWA_FW_RESP_ERROR_FAILED,	\
 		    format " %d(%s)", arg, errno, strerror(errno))
 
 typedef struct {
 	HinawaFwNode *node;
+	guint64 closure;
 
 	guint64 offset;
 	guint width;
@@ -47,6 +48,15 @@ typedef struct {
 	gsize req_length;
 	guint8 *resp_frame;
 	gsize resp_length;
+
+	// The event in the buffer of node, available during emission of the signal.
+	gconstpointer event;
+	const guint8 *frame;
+	gsize frame_size;
+
+	// The function called without emission of signal. It is called without the lock.
+	GMutex mutex;
+	struct hinawa_callback *requested_cb;
 } HinawaFwRespPrivate;
 G_DEFINE_TYPE_WITH_PRIVATE(HinawaFwResp, hinawa_fw_resp, G_TYPE_OBJECT)
 
@@ -88,12 +98,30 @@ static void fw_resp_get_property(GObject *obj, guint id, GValue *val,
 	}
 }
 
+static void fw_resp_dispose(GObject *obj)
+{
+	HinawaFwResp *self = HINAWA_FW_RESP(obj);
+	HinawaFwRespPrivate *priv = hinawa_fw_resp_get_instance_private(self);
+
+	if (priv->closure > 0) {
+		hinawa_closure_unregister(priv->closure);
+		priv->closure = 0;
+	}
+
+	G_OBJECT_CLASS(hinawa_fw_resp_parent_class)->dispose(obj);
+}
+
 static void fw_resp_finalize(GObject *obj)
 {
 	HinawaFwResp *self = HINAWA_FW_RESP(obj);
+	HinawaFwRespPrivate *priv = hinawa_fw_resp_get_instance_private(self);
 
 	hinawa_fw_resp_release(self);
 
+	if (priv->requested_cb != NULL)
+		hinawa_callback_unref(priv->requested_cb);
+	g_mutex_clear(&priv->mutex);
+
 	G_OBJECT_CLASS(hinawa_fw_resp_parent_class)->finalize(obj);
 }
 
@@ -102,6 +130,7 @@ static void hinawa_fw_resp_class_init(HinawaFwRespClass *klass)
 	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
 
 	gobject_class->get_property = fw_resp_get_property;
+	gobject_class->dispose = fw_resp_dispose;
 	gobject_class->finalize = fw_resp_finalize;
 
 	/**
@@ -170,6 +199,12 @@ static void hinawa_fw_resp_class_init(HinawaFwRespClass *klass)
 	 * The handler is expected to call [method@FwResp.set_resp_frame] with frame and return
 	 * [enum@FwRcode] for response subaction.
 	 *
+	 * The @frame is available only during the emission. The handler can retrieve it by
+	 * [method@FwResp.get_frame_bytes] to keep it without copying.
+	 *
+	 * The signal is not emitted when the function is set by
+	 * [method@FwResp.set_requested_func] and no handler is connected.
+	 *
 	 * The value of @tstamp is unsigned 16 bit integer including higher 3 bits for three low
 	 * order bits of second field and the rest 13 bits for cycle field in the format of IEEE
 	 * 1394 CYCLE_TIMER register.
@@ -192,11 +227,17 @@ static void hinawa_fw_resp_class_init(HinawaFwRespClass *klass)
 			     HINAWA_TYPE_FW_RCODE, 9, HINAWA_TYPE_FW_TCODE, G_TYPE_UINT64,
 			     G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT,
 			     G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_UINT);
+	g_signal_set_va_marshaller(fw_resp_sigs[FW_RESP_SIG_TYPE_REQ],
+				   G_OBJECT_CLASS_TYPE(klass),
+				   hinawa_sigs_marshal_ENUM__ENUM_UINT64_UINT_UINT_UINT_UINT_UINT_POINTER_UINTv);
 }
 
 static void hinawa_fw_resp_init(HinawaFwResp *self)
 {
-	return;
+	HinawaFwRespPrivate *priv = hinawa_fw_resp_get_instance_private(self);
+
+	priv->closure = hinawa_closure_register(HINAWA_CLOSURE_KIND_FW_RESP, self);
+	g_mutex_init(&priv->mutex);
 }
 
 /**
@@ -252,7 +293,7 @@ gboolean hinawa_fw_resp_reserve_within_region(HinawaFwResp *self, HinawaFwNode *
 	}
 
 	allocate.offset = region_start;
-	allocate.closure = (guint64)self;
+	allocate.closure = priv->closure;
 	allocate.length = width;
 	allocate.region_end = region_end;
 
@@ -263,7 +304,8 @@ gboolean hinawa_fw_resp_reserve_within_region(HinawaFwResp *self, HinawaFwNode *
 		if (err == EBUSY)
 			generate_local_error(error, HINAWA_FW_RESP_ERROR_ADDR_SPACE_USED);
 		else
-			generate_syscall_error(error, err, "ioctl(%s)", "FW_CDEV_IOC_ALLOCATE");
+			generate_resp_syscall_error(error, err, "ioctl(%s)",
+						    "FW_CDEV_IOC_ALLOCATE");
 		return FALSE;
 	}
 
@@ -374,6 +416,114 @@ void hinawa_fw_resp_set_resp_frame(HinawaFwResp *self, guint8 *frame,
 	}
 }
 
+/**
+ * hinawa_fw_resp_get_frame_bytes:
+ * @self: A [class@FwResp].
+ * @frame: (out)(transfer full)(nullable): The [struct@GLib.Bytes] for byte data of request
+ *	   subaction.
+ *
+ * Retrieve byte data of request subaction as [struct@GLib.Bytes] which refers to the buffer in
+ * which the event was read, instead of copying it. The function is available only in handlers of
+ * [signal@FwResp::requested]. The handler can keep the bytes after returning, then the buffer is
+ * recycled to read the other events once the bytes is released.
+ *
+ * Returns: TRUE if the request subaction is available, otherwise FALSE.
+ *
+ * Since: 4.1
+ */
+gboolean hinawa_fw_resp_get_frame_bytes(HinawaFwResp *self, GBytes **frame)
+{
+	HinawaFwRespPrivate *priv;
+
+	g_return_val_if_fail(HINAWA_IS_FW_RESP(self), FALSE);
+	g_return_val_if_fail(frame != NULL, FALSE);
+	priv = hinawa_fw_resp_get_instance_private(self);
+
+	if (priv->event == NULL) {
+		*frame = NULL;
+		return FALSE;
+	}
+
+	*frame = hinawa_buffer_slice(priv->event, priv->frame, priv->frame_size);
+
+	return TRUE;
+}
+
+/**
+ * hinawa_fw_resp_set_requested_func:
+ * @self: A [class@FwResp].
+ * @func: (scope notified)(closure user_data)(destroy notify)(nullable): The function called
+ *	  when the request subaction arrives, or NULL to unset it.
+ * @user_data: The data passed to @func.
+ * @notify: (nullable): The function called to release @user_data when @func is unset.
+ *
+ * Set the function called with the same arguments as [signal@FwResp::requested], before the
+ * signal is emitted. The function is called directly in the thread to dispatch events, without
+ * boxing the arguments, thus it is suitable for the single consumer of the request. The value
+ * returned by the function is used for the response subaction unless the signal is emitted. When
+ * the function is set, the signal is emitted only if any handler is connected to the signal or
+ * the class closure is overridden. The function is called without any lock, thus it can set
+ * the other function. The @notify is called after the function is unset and the call in progress
+ * returns.
+ *
+ * Since: 4.1
+ */
+void hinawa_fw_resp_set_requested_func(HinawaFwResp *self, HinawaFwRespRequestedFunc func,
+				       gpointer user_data, GDestroyNotify notify)
+{
+	HinawaFwRespPrivate *priv;
+
+	g_return_if_fail(HINAWA_IS_FW_RESP(self));
+	priv = hinawa_fw_resp_get_instance_private(self);
+
+	hinawa_callback_replace(&priv->requested_cb, &priv->mutex,
+				hinawa_callback_new(G_CALLBACK(func), user_data, notify));
+}
+
+// The function is called at first, then the signal is emitted just for connected handlers or the
+// class closure. The event should be in the buffer taken from the pool.
+static HinawaFwRcode emit_requested(HinawaFwResp *self, gconstpointer event, HinawaFwTcode tcode,
+				    guint64 offset, guint src_node_id, guint dst_node_id,
+				    guint card_id, guint generation, guint tstamp,
+				    const __u32 *data, guint length)
+{
+	HinawaFwRespPrivate *priv = hinawa_fw_resp_get_instance_private(self);
+	HinawaFwRespClass *klass = HINAWA_FW_RESP_GET_CLASS(self);
+	const guint8 *frame = (const guint8 *)data;
+	HinawaFwRcode rcode = HINAWA_FW_RCODE_ADDRESS_ERROR;
+	struct hinawa_callback *cb;
+	gboolean direct;
+
+	priv->event = event;
+	priv->frame = frame;
+	priv->frame_size = length;
+
+	cb = hinawa_callback_get(&priv->requested_cb, &priv->mutex);
+	direct = cb != NULL;
+	if (direct) {
+		rcode = ((HinawaFwRespRequestedFunc)cb->func)(self, tcode, offset, src_node_id,
+							      dst_node_id, card_id, generation,
+							      tstamp, frame, length, cb->data);
+		hinawa_callback_unref(cb);
+	}
+
+	if (g_signal_has_handler_pending(self, fw_resp_sigs[FW_RESP_SIG_TYPE_REQ], 0, FALSE) ||
+	    (!direct && klass->requested == NULL)) {
+		g_signal_emit(self, fw_resp_sigs[FW_RESP_SIG_TYPE_REQ], 0, tcode, offset,
+			      src_node_id, dst_node_id, card_id, generation, tstamp, frame, length,
+			      &rcode);
+	} else if (klass->requested != NULL) {
+		rcode = klass->requested(self, tcode, offset, src_node_id, dst_node_id, card_id,
+					 generation, tstamp, frame, length);
+	}
+
+	priv->event = NULL;
+	priv->frame = NULL;
+	priv->frame_size = 0;
+
+	return rcode;
+}
+
 // NOTE: For HinawaFwNode, internal.
 void hinawa_fw_resp_handle_request(HinawaFwResp *self, const struct fw_cdev_event_request *event)
 {
@@ -391,11 +541,13 @@ void hinawa_fw_resp_handle_request(HinawaFwResp *self, const struct fw_cdev_even
 	if (!priv->node || event->length > priv->width) {
 		rcode = RCODE_CONFLICT_ERROR;
 	} else {
-		g_signal_emit(self, fw_resp_sigs[FW_RESP_SIG_TYPE_REQ], 0, event->tcode,
-			      event->offset, G_MAXUINT, G_MAXUINT, G_MAXUINT, G_MAXUINT,
-			      G_MAXUINT, event->data, event->length, &rcode);
+		rcode = emit_requested(self, event, event->tcode, event->offset, G_MAXUINT,
+				       G_MAXUINT, G_MAXUINT, G_MAXUINT, G_MAXUINT, event->data,
+				       event->length);
 	}
 
+	HINAWA_PROBE5(request_handled, self, event->tcode, event->offset, event->length, rcode);
+
 	if (priv->resp_length > 0) {
 		resp.length = priv->resp_length;
 		resp.data = (guint64)priv->resp_frame;
@@ -404,7 +556,8 @@ void hinawa_fw_resp_handle_request(HinawaFwResp *self, const struct fw_cdev_even
 	// Ignore ioctl error.
 	resp.rcode = (__u32)rcode;
 	resp.handle = event->handle;
-	hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error);
+	if (hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error) == 0)
+		HINAWA_PROBE3(response_sent, self, rcode, resp.length);
 	g_clear_error(&error);
 }
 
@@ -425,14 +578,14 @@ void hinawa_fw_resp_handle_request2(HinawaFwResp *self, const struct fw_cdev_eve
 	if (!priv->node || event->length > priv->width) {
 		rcode = RCODE_CONFLICT_ERROR;
 	} else {
-		rcode = HINAWA_FW_RCODE_ADDRESS_ERROR;
-
-		g_signal_emit(self, fw_resp_sigs[FW_RESP_SIG_TYPE_REQ], 0, event->tcode,
-			      event->offset, event->source_node_id, event->destination_node_id,
-			      event->card, event->generation, G_MAXUINT, event->data, event->length,
-			      &rcode);
+		rcode = emit_requested(self, event, event->tcode, event->offset,
+				       event->source_node_id, event->destination_node_id,
+				       event->card, event->generation, G_MAXUINT, event->data,
+				       event->length);
 	}
 
+	HINAWA_PROBE5(request_handled, self, event->tcode, event->offset, event->length, rcode);
+
 	if (priv->resp_length > 0) {
 		resp.length = priv->resp_length;
 		resp.data = (guint64)priv->resp_frame;
@@ -441,7 +594,8 @@ void hinawa_fw_resp_handle_request2(HinawaFwResp *self, const struct fw_cdev_eve
 	// Ignore ioctl error.
 	resp.rcode = (__u32)rcode;
 	resp.handle = event->handle;
-	hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error);
+	if (hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error) == 0)
+		HINAWA_PROBE3(response_sent, self, rcode, resp.length);
 	g_clear_error(&error);
 }
 
@@ -462,14 +616,14 @@ void hinawa_fw_resp_handle_request3(HinawaFwResp *self, const struct fw_cdev_eve
 	if (!priv->node || event->length > priv->width) {
 		rcode = RCODE_CONFLICT_ERROR;
 	} else {
-		rcode = HINAWA_FW_RCODE_ADDRESS_ERROR;
-
-		g_signal_emit(self, fw_resp_sigs[FW_RESP_SIG_TYPE_REQ], 0, event->tcode,
-			      event->offset, event->source_node_id, event->destination_node_id,
-			      event->card, event->generation, event->tstamp, event->data,
-			      event->length, &rcode);
+		rcode = emit_requested(self, event, event->tcode, event->offset,
+				       event->source_node_id, event->destination_node_id,
+				       event->card, event->generation, event->tstamp, event->data,
+				       event->length);
 	}
 
+	HINAWA_PROBE5(request_handled, self, event->tcode, event->offset, event->length, rcode);
+
 	if (priv->resp_length > 0) {
 		resp.length = priv->resp_length;
 		resp.data = (guint64)priv->resp_frame;
@@ -478,6 +632,7 @@ void hinawa_fw_resp_handle_request3(HinawaFwResp *self, const struct fw_cdev_eve
 	// Ignore ioctl error.
 	resp.rcode = (__u32)rcode;
 	resp.handle = event->handle;
-	hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error);
+	if (hinawa_fw_node_ioctl(priv->node, FW_CDEV_IOC_SEND_RESPONSE, &resp, &error) == 0)
+		HINAWA_PROBE3(response_sent, self, rcode, resp.length);
 	g_clear_error(&error);
 }
@@ -45,6 +45,35 @@ struct _HinawaFwRespClass {
 				   const guint8 *frame, guint length);
 };
 
+/**
+ * HinawaFwRespRequestedFunc:
+ * @self: A [class@FwResp]
+ * @tcode: One of [enum@FwTcode] enumerations
+ * @offset: The address offset at which the transaction arrives.
+ * @src_node_id: The node ID of source for the transaction.
+ * @dst_node_id: The node ID of destination for the transaction.
+ * @card_id: The index of card specific to 1394 OHCI hardware at which the request subaction
+ *	     arrived.
+ * @generation: The generation of bus when the transaction is transferred.
+ * @tstamp: The time stamp at which the request arrived.
+ * @frame: (element-type guint8)(array length=length): The array with elements for byte data.
+ * @length: The length of bytes for the frame.
+ * @user_data: The data given to [method@FwResp.set_requested_func].
+ *
+ * The function called with the same arguments as [signal@FwResp::requested].
+ *
+ * Returns: One of [enum@FwRcode] enumerations corresponding to rcodes defined in IEEE 1394
+ *	    specification.
+ *
+ * Since: 4.1
+ */
+typedef HinawaFwRcode (*HinawaFwRespRequestedFunc)(HinawaFwResp *self, HinawaFwTcode tcode,
+						   guint64 offset, guint src_node_id,
+						   guint dst_node_id, guint card_id,
+						   guint generation, guint tstamp,
+						   const guint8 *frame, guint length,
+						   gpointer user_data);
+
 HinawaFwResp *hinawa_fw_resp_new(void);
 
 gboolean hinawa_fw_resp_reserve_within_region(HinawaFwResp *self, HinawaFwNode *node,
@@ -54,6 +83,11 @@ gboolean hinawa_fw_resp_reserve(HinawaFwResp *self, HinawaFwNode*node, guint64 a
 				GError **error);
 void hinawa_fw_resp_release(HinawaFwResp *self);
 
+gboolean hinawa_fw_resp_get_frame_bytes(HinawaFwResp *self, GBytes **frame);
+
+void hinawa_fw_resp_set_requested_func(HinawaFwResp *self, HinawaFwRespRequestedFunc func,
+				       gpointer user_data, GDestroyNotify notify);
+
 void hinawa_fw_resp_set_resp_frame(HinawaFwResp *self, guint8 *frame,
 				   gsize length);
 
@@ -14,10 +14,14 @@
 #include <hinawa_enums.h>
 
 #include <cycle_time.h>
+#include <config_rom.h>
 
 #include <fw_node.h>
 #include <fw_resp.h>
 #include <fw_req.h>
 #include <fw_fcp.h>
+#include <fw_dispatcher.h>
+#include <fw_monitor.h>
+#include <config_rom_cache.h>
 
 #endif
@@ -165,6 +165,23 @@ typedef enum {
 	HINAWA_FW_FCP_ERROR_ABORTED,
 } HinawaFwFcpError;
 
+/**
+ * HinawaFwNodeEventClass:
+ * @HINAWA_FW_NODE_EVENT_CLASS_BUS_RESET:	The event of bus reset.
+ * @HINAWA_FW_NODE_EVENT_CLASS_RESPONSE:	The event of response for [class@FwReq].
+ * @HINAWA_FW_NODE_EVENT_CLASS_REQUEST:		The event of request for [class@FwResp].
+ *
+ * A set of flags for the class of events dispatched by the source retrieved by
+ * [method@FwNode.create_filtered_source].
+ *
+ * Since: 4.1
+ */
+typedef enum /*< flags >*/ {
+	HINAWA_FW_NODE_EVENT_CLASS_BUS_RESET	= (1 << 0),
+	HINAWA_FW_NODE_EVENT_CLASS_RESPONSE	= (1 << 1),
+	HINAWA_FW_NODE_EVENT_CLASS_REQUEST	= (1 << 2),
+} HinawaFwNodeEventClass;
+
 G_END_DECLS
 
 #endif
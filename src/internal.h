@@ -4,13 +4,107 @@
 
 #include "hinawa.h"
 
+// Static probes for user space tracers. They are no-op unless the library is built with them.
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define HINAWA_PROBE2(name, a1, a2)			DTRACE_PROBE2(hinawa, name, a1, a2)
+#define HINAWA_PROBE3(name, a1, a2, a3)			DTRACE_PROBE3(hinawa, name, a1, a2, a3)
+#define HINAWA_PROBE5(name, a1, a2, a3, a4, a5)		DTRACE_PROBE5(hinawa, name, a1, a2, a3, a4, a5)
+#else
+#define HINAWA_PROBE2(name, a1, a2)			do { } while (0)
+#define HINAWA_PROBE3(name, a1, a2, a3)			do { } while (0)
+#define HINAWA_PROBE5(name, a1, a2, a3, a4, a5)		do { } while (0)
+#endif
+
+// The failure of system call at the node, the dispatcher, and the monitor.
+#define generate_syscall_error(error, errno, format, arg)				\
+	g_set_error(error, HINAWA_FW_NODE_ERROR, HINAWA_FW_NODE_ERROR_FAILED,	\
+		    format " %d(%s)", arg, errno, strerror(errno))
+
+enum hinawa_closure_kind {
+	HINAWA_CLOSURE_KIND_FW_NODE = 1,
+	HINAWA_CLOSURE_KIND_FW_RESP,
+	HINAWA_CLOSURE_KIND_FW_REQ,
+};
+
+guint64 hinawa_closure_register(enum hinawa_closure_kind kind, gpointer instance);
+void hinawa_closure_unregister(guint64 closure);
+guint64 hinawa_closure_renew(guint64 closure);
+gpointer hinawa_closure_lookup(guint64 closure, enum hinawa_closure_kind *kind);
+
+struct hinawa_callback {
+	gint ref_count;
+	GCallback func;
+	gpointer data;
+	GDestroyNotify notify;
+};
+struct hinawa_callback *hinawa_callback_new(GCallback func, gpointer data, GDestroyNotify notify);
+struct hinawa_callback *hinawa_callback_ref(struct hinawa_callback *cb);
+void hinawa_callback_unref(struct hinawa_callback *cb);
+void hinawa_callback_replace(struct hinawa_callback **slot, GMutex *mutex,
+			     struct hinawa_callback *cb);
+struct hinawa_callback *hinawa_callback_get(struct hinawa_callback *const *slot, GMutex *mutex);
+
+guint64 hinawa_config_rom_compute_hash(GBytes *image);
+gboolean hinawa_config_rom_parse_guid(GBytes *image, guint64 *guid);
+void hinawa_config_rom_serialize(const HinawaConfigRom *self, GByteArray *buf);
+HinawaConfigRom *hinawa_config_rom_deserialize(GBytes *image, const guint8 *data, gsize size);
+
+struct hinawa_buffer_pool;
+struct hinawa_buffer_pool *hinawa_buffer_pool_new(gsize size, guint max_cached);
+void hinawa_buffer_pool_unref(struct hinawa_buffer_pool *pool);
+gsize hinawa_buffer_pool_get_size(const struct hinawa_buffer_pool *pool);
+gpointer hinawa_buffer_pool_acquire(struct hinawa_buffer_pool *pool);
+gpointer hinawa_buffer_ref(gpointer buf);
+void hinawa_buffer_unref(gpointer buf);
+void hinawa_buffer_set_length(gpointer buf, gsize length);
+gsize hinawa_buffer_get_length(gconstpointer buf);
+GBytes *hinawa_buffer_slice(gconstpointer buf, gconstpointer data, gsize length);
+
+typedef void (*HinawaMonitorEventFunc)(const gchar *name, gboolean added, gpointer user_data);
+gboolean hinawa_monitor_event_is_device_name(const gchar *name);
+void hinawa_monitor_event_parse(const guint8 *buf, gsize length,
+				HinawaMonitorEventFunc func, gpointer user_data);
+
+// The backend of I/O for the node. Each function returns -1 and sets errno at failure in the
+// same manner as the system call. The file descriptor returned by open() should be pollable
+// for the availability of event.
+struct hinawa_fw_node_backend {
+	int (*open)(const char *path, int flags, gpointer *data);
+	void (*close)(int fd, gpointer data);
+	int (*ioctl)(int fd, unsigned long req, void *args, gpointer data);
+	ssize_t (*read)(int fd, void *buf, size_t length, gpointer data);
+};
+
+extern const struct hinawa_fw_node_backend hinawa_fw_node_kernel_backend;
+extern const struct hinawa_fw_node_backend hinawa_fw_node_sim_backend;
+extern const struct hinawa_fw_node_backend hinawa_fw_node_recorder_backend;
+extern const struct hinawa_fw_node_backend hinawa_fw_node_replay_backend;
+const struct hinawa_fw_node_backend *hinawa_fw_node_backend_lookup(const char *path);
+int hinawa_fw_node_recorder_open(const struct hinawa_fw_node_backend *inner, const char *path,
+				 const char *record_path, int flags, gpointer *data);
+gboolean hinawa_fw_node_replay_path(const char *path);
+
 int hinawa_fw_node_ioctl(HinawaFwNode *self, unsigned long req, void *args, GError **exception);
 void hinawa_fw_node_invalidate_transaction(HinawaFwNode *self, HinawaFwReq *req);
+int hinawa_fw_node_get_fd(HinawaFwNode *self);
+gboolean hinawa_fw_node_dispatch(HinawaFwNode *self, GIOCondition condition);
+void hinawa_fw_node_handle_disconnection(HinawaFwNode *self);
+const gchar *hinawa_fw_node_get_path(HinawaFwNode *self);
 
 void hinawa_fw_resp_handle_request(HinawaFwResp *self, const struct fw_cdev_event_request *event);
 void hinawa_fw_resp_handle_request2(HinawaFwResp *self, const struct fw_cdev_event_request2 *event);
 void hinawa_fw_resp_handle_request3(HinawaFwResp *self, const struct fw_cdev_event_request3 *event);
 void hinawa_fw_req_handle_response(HinawaFwReq *self, const struct fw_cdev_event_response *event);
 void hinawa_fw_req_handle_response2(HinawaFwReq *self, const struct fw_cdev_event_response2 *event);
+void hinawa_fw_req_handle_bus_reset(HinawaFwReq *self, HinawaFwNode *node);
+
+// The state of transaction in flight, kept in the instance of HinawaFwReq and accessed by
+// HinawaFwNode under the lock of its table of transactions.
+struct hinawa_fw_req_transaction {
+	gint64 issued;
+	guint32 generation;
+};
+struct hinawa_fw_req_transaction *hinawa_fw_req_get_transaction(HinawaFwReq *self);
 
 #endif
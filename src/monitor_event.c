@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+#include <sys/inotify.h>
+
+// The parser of inotify events for the directory of Linux FireWire character devices. It is
+// independent of the instance of monitor so that the unit test can feed the handcrafted buffer.
+
+#define DEVICE_PREFIX		"fw"
+
+gboolean hinawa_monitor_event_is_device_name(const gchar *name)
+{
+	const gchar *digits;
+
+	if (!g_str_has_prefix(name, DEVICE_PREFIX))
+		return FALSE;
+
+	digits = name + strlen(DEVICE_PREFIX);
+	if (*digits == '\0')
+		return FALSE;
+
+	while (*digits != '\0') {
+		if (!g_ascii_isdigit(*digits))
+			return FALSE;
+		++digits;
+	}
+
+	return TRUE;
+}
+
+// The kernel never splits the event, while the parser stops at the event truncated anyway.
+void hinawa_monitor_event_parse(const guint8 *buf, gsize length,
+				HinawaMonitorEventFunc func, gpointer user_data)
+{
+	const guint8 *pos = buf;
+	const guint8 *end = buf + length;
+
+	while (end - pos >= (gssize)sizeof(struct inotify_event)) {
+		const struct inotify_event *event = (const struct inotify_event *)pos;
+		gsize size = sizeof(*event) + event->len;
+
+		if ((gsize)(end - pos) < size)
+			break;
+
+		// The name is padded by null characters.
+		if (event->len > 0 && strnlen(event->name, event->len) < event->len &&
+		    hinawa_monitor_event_is_device_name(event->name)) {
+			if (event->mask & IN_CREATE)
+				func(event->name, TRUE, user_data);
+			else if (event->mask & IN_DELETE)
+				func(event->name, FALSE, user_data);
+		}
+
+		pos += size;
+	}
+}
@@ -0,0 +1,558 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+
+// The file to record the events read from the node and the ioctls issued to it. The file is
+// append-only and consists of the header and records aligned to 8 bytes, thus it can be mapped
+// to memory for replay. The file is in host-endian, thus it should not be shared between
+// systems:
+//
+//   header:	magic 'HNWR', version, reserved (16 bytes).
+//   record:	type, length of payload, time in microseconds since the node is opened (16 bytes),
+//		then payload.
+//
+// The payload of event record is the content of event as read. The payload of ioctl record is
+// the request, the result, the errno, and the content of argument after the call. For
+// FW_CDEV_IOC_GET_INFO, the content of configuration ROM and the event of bus reset follow it.
+//
+// At replay, the event records are delivered in the order. The ioctl record is consumed when
+// the same request is issued, then the closures in the argument are associated to the ones in
+// the record, so that the closures in the events are replaced with the live ones. Till the
+// ioctl record is consumed, the subsequent events are not delivered. The ioctl issued while the
+// subsequent events are not delivered yet waits for them. The ioctl different from the record
+// fails with EPROTO since the replay diverges from the record.
+
+#define RECORD_MAGIC		0x52574e48	// 'HNWR' in little endian.
+#define RECORD_VERSION		1
+#define RECORD_ALIGN		8
+
+// The path to replay the record with the original timing, or as fast as possible.
+#define REPLAY_PATH_PREFIX	"replay:"
+#define REPLAY_FAST_PATH_PREFIX	"replay-fast:"
+
+// The maximum size of configuration ROM, same as the one in fw_node.c.
+#define MAX_CONFIG_ROM_LENGTH	1024
+
+enum record_type {
+	RECORD_TYPE_EVENT = 1,
+	RECORD_TYPE_IOCTL,
+};
+
+struct record_file_header {
+	guint32 magic;
+	guint32 version;
+	guint64 reserved;
+};
+
+struct record_header {
+	guint32 type;
+	guint32 length;
+	gint64 timestamp;
+};
+
+struct record_ioctl {
+	guint64 req;
+	gint32 result;
+	gint32 err;
+	guint8 args[];
+};
+
+struct recorder {
+	const struct hinawa_fw_node_backend *inner;
+	gpointer inner_data;
+
+	GMutex mutex;
+	int out;
+	gint64 start;
+};
+
+static void write_record(struct recorder *rec, enum record_type type, const void *head,
+			 gsize head_length, const void *body, gsize body_length)
+{
+	static const guint8 padding[RECORD_ALIGN] = {0};
+	struct record_header header;
+	struct iovec iov[4];
+	gsize length = head_length + body_length;
+
+	header.type = type;
+	header.length = length;
+	header.timestamp = g_get_monotonic_time() - rec->start;
+
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = (void *)head;
+	iov[1].iov_len = head_length;
+	iov[2].iov_base = (void *)body;
+	iov[2].iov_len = body_length;
+	iov[3].iov_base = (void *)padding;
+	iov[3].iov_len = (RECORD_ALIGN - length % RECORD_ALIGN) % RECORD_ALIGN;
+
+	// The record is lost when the file is not writable anymore.
+	g_mutex_lock(&rec->mutex);
+	(void)!writev(rec->out, iov, G_N_ELEMENTS(iov));
+	g_mutex_unlock(&rec->mutex);
+}
+
+// Open the node by the backend, then record the events read from it and the ioctls issued to it
+// into the file.
+int hinawa_fw_node_recorder_open(const struct hinawa_fw_node_backend *inner, const char *path,
+				 const char *record_path, int flags, gpointer *data)
+{
+	struct record_file_header header = {
+		.magic = RECORD_MAGIC,
+		.version = RECORD_VERSION,
+	};
+	struct recorder *rec;
+	int fd;
+
+	rec = g_new0(struct recorder, 1);
+	rec->inner = inner;
+	rec->out = open(record_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+	if (rec->out < 0) {
+		g_free(rec);
+		return -1;
+	}
+
+	if (write(rec->out, &header, sizeof(header)) != sizeof(header)) {
+		int err = errno;
+
+		close(rec->out);
+		g_free(rec);
+		errno = err;
+		return -1;
+	}
+
+	fd = inner->open(path, flags, &rec->inner_data);
+	if (fd < 0) {
+		int err = errno;
+
+		close(rec->out);
+		g_free(rec);
+		errno = err;
+		return -1;
+	}
+
+	g_mutex_init(&rec->mutex);
+	rec->start = g_get_monotonic_time();
+	*data = rec;
+
+	return fd;
+}
+
+static void recorder_close(int fd, gpointer data)
+{
+	struct recorder *rec = data;
+
+	rec->inner->close(fd, rec->inner_data);
+
+	close(rec->out);
+	g_mutex_clear(&rec->mutex);
+	g_free(rec);
+}
+
+static int recorder_ioctl(int fd, unsigned long req, void *args, gpointer data)
+{
+	struct recorder *rec = data;
+	struct record_ioctl head;
+	GByteArray *body;
+	int result;
+
+	head.req = req;
+	head.result = rec->inner->ioctl(fd, req, args, rec->inner_data);
+	head.err = head.result < 0 ? errno : 0;
+	result = head.result;
+
+	body = g_byte_array_sized_new(_IOC_SIZE(req) + MAX_CONFIG_ROM_LENGTH);
+	g_byte_array_append(body, args, _IOC_SIZE(req));
+
+	if (req == FW_CDEV_IOC_GET_INFO && result == 0) {
+		const struct fw_cdev_get_info *info = args;
+		struct fw_cdev_event_bus_reset bus_reset = {0};
+		guint32 rom_length = MIN(info->rom_length, MAX_CONFIG_ROM_LENGTH);
+
+		g_byte_array_append(body, (const guint8 *)&rom_length, sizeof(rom_length));
+		if (info->rom != 0)
+			g_byte_array_append(body, (const guint8 *)info->rom, rom_length);
+		else
+			g_byte_array_set_size(body, body->len + rom_length);
+		if (info->bus_reset != 0)
+			memcpy(&bus_reset, (const void *)info->bus_reset, sizeof(bus_reset));
+		g_byte_array_append(body, (const guint8 *)&bus_reset, sizeof(bus_reset));
+	}
+
+	write_record(rec, RECORD_TYPE_IOCTL, &head, sizeof(head), body->data, body->len);
+	g_byte_array_unref(body);
+
+	errno = head.err;
+
+	return result;
+}
+
+static ssize_t recorder_read(int fd, void *buf, size_t length, gpointer data)
+{
+	struct recorder *rec = data;
+	ssize_t len;
+
+	len = rec->inner->read(fd, buf, length, rec->inner_data);
+	if (len > 0)
+		write_record(rec, RECORD_TYPE_EVENT, buf, len, NULL, 0);
+
+	return len;
+}
+
+// The open function is not used since hinawa_fw_node_recorder_open() is called instead.
+const struct hinawa_fw_node_backend hinawa_fw_node_recorder_backend = {
+	.close	= recorder_close,
+	.ioctl	= recorder_ioctl,
+	.read	= recorder_read,
+};
+
+struct replayer {
+	int fd;
+	gboolean fast;
+
+	GMappedFile *file;
+	GArray *records;
+
+	GMutex mutex;
+	GCond cond;
+	GThread *thread;
+	gboolean running;
+	guint next;
+	GQueue ready;
+	GHashTable *closures;
+};
+
+static const struct record_header *get_record(struct replayer *rep, guint index)
+{
+	const guint8 *contents = (const guint8 *)g_mapped_file_get_contents(rep->file);
+
+	return (const struct record_header *)(contents + g_array_index(rep->records, gsize, index));
+}
+
+// Check the records and build the index.
+static gboolean index_records(struct replayer *rep)
+{
+	const guint8 *contents = (const guint8 *)g_mapped_file_get_contents(rep->file);
+	gsize length = g_mapped_file_get_length(rep->file);
+	const struct record_file_header *file_header = (const struct record_file_header *)contents;
+	gsize pos;
+
+	if (length < sizeof(*file_header) || file_header->magic != RECORD_MAGIC ||
+	    file_header->version != RECORD_VERSION)
+		return FALSE;
+
+	// The record truncated at the end of file is ignored.
+	pos = sizeof(*file_header);
+	while (pos + sizeof(struct record_header) <= length) {
+		const struct record_header *header = (const struct record_header *)(contents + pos);
+		gsize size = sizeof(*header) + header->length;
+
+		if (pos + size > length)
+			break;
+		if (header->type == RECORD_TYPE_IOCTL && header->length < sizeof(struct record_ioctl))
+			return FALSE;
+
+		g_array_append_val(rep->records, pos);
+		pos += (size + RECORD_ALIGN - 1) & ~((gsize)RECORD_ALIGN - 1);
+	}
+
+	return TRUE;
+}
+
+static gpointer run_replay(gpointer data)
+{
+	struct replayer *rep = data;
+	gint64 base = g_get_monotonic_time();
+	gint64 prev = 0;
+
+	g_mutex_lock(&rep->mutex);
+
+	while (rep->running && rep->next < rep->records->len) {
+		const struct record_header *header = get_record(rep, rep->next);
+
+		if (header->type == RECORD_TYPE_IOCTL) {
+			// Wait for the ioctl to be issued.
+			g_cond_wait(&rep->cond, &rep->mutex);
+			base = g_get_monotonic_time();
+			prev = header->timestamp;
+			continue;
+		}
+
+		if (!rep->fast) {
+			gint64 due = base + header->timestamp - prev;
+
+			if (g_get_monotonic_time() < due) {
+				g_cond_wait_until(&rep->cond, &rep->mutex, due);
+				continue;
+			}
+			base = due;
+			prev = header->timestamp;
+		}
+
+		if (header->type == RECORD_TYPE_EVENT) {
+			g_queue_push_tail(&rep->ready, (gpointer)header);
+			eventfd_write(rep->fd, 1);
+		}
+		++rep->next;
+		// For the ioctl waiting for the events.
+		g_cond_broadcast(&rep->cond);
+	}
+
+	g_mutex_unlock(&rep->mutex);
+
+	return NULL;
+}
+
+static int replay_open(const char *path, int flags, gpointer *data)
+{
+	struct replayer *rep;
+	GError *error = NULL;
+	int fd;
+
+	rep = g_new0(struct replayer, 1);
+	if (g_str_has_prefix(path, REPLAY_FAST_PATH_PREFIX)) {
+		rep->fast = TRUE;
+		path += strlen(REPLAY_FAST_PATH_PREFIX);
+	} else {
+		path += strlen(REPLAY_PATH_PREFIX);
+	}
+
+	rep->file = g_mapped_file_new(path, FALSE, &error);
+	if (rep->file == NULL) {
+		errno = g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT) ? ENOENT : EIO;
+		g_error_free(error);
+		g_free(rep);
+		return -1;
+	}
+
+	rep->records = g_array_new(FALSE, FALSE, sizeof(gsize));
+	if (!index_records(rep)) {
+		g_array_unref(rep->records);
+		g_mapped_file_unref(rep->file);
+		g_free(rep);
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+	if (fd < 0) {
+		int err = errno;
+
+		g_array_unref(rep->records);
+		g_mapped_file_unref(rep->file);
+		g_free(rep);
+		errno = err;
+		return -1;
+	}
+	rep->fd = fd;
+
+	g_mutex_init(&rep->mutex);
+	g_cond_init(&rep->cond);
+	g_queue_init(&rep->ready);
+	rep->closures = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+
+	rep->running = TRUE;
+	rep->thread = g_thread_new("hinawa-replay", run_replay, rep);
+
+	*data = rep;
+
+	return fd;
+}
+
+static void replay_close(int fd, gpointer data)
+{
+	struct replayer *rep = data;
+
+	g_mutex_lock(&rep->mutex);
+	rep->running = FALSE;
+	g_cond_broadcast(&rep->cond);
+	g_mutex_unlock(&rep->mutex);
+	g_thread_join(rep->thread);
+
+	g_queue_clear(&rep->ready);
+	g_hash_table_unref(rep->closures);
+	g_array_unref(rep->records);
+	g_mapped_file_unref(rep->file);
+	g_cond_clear(&rep->cond);
+	g_mutex_clear(&rep->mutex);
+	g_free(rep);
+
+	close(fd);
+}
+
+static void associate_closure(struct replayer *rep, guint64 recorded, guint64 live)
+{
+	gint64 *key = g_new(gint64, 1);
+	gint64 *value = g_new(gint64, 1);
+
+	*key = recorded;
+	*value = live;
+	g_hash_table_replace(rep->closures, key, value);
+}
+
+// Should be called with the mutex.
+static int replay_record_ioctl(struct replayer *rep, const struct record_header *header,
+			       unsigned long req, void *args)
+{
+	const struct record_ioctl *record = (const struct record_ioctl *)(header + 1);
+	gsize size = _IOC_SIZE(req);
+
+	if (header->length < sizeof(*record) + size)
+		return -EINVAL;
+
+	switch (req) {
+	case FW_CDEV_IOC_GET_INFO:
+	{
+		const struct fw_cdev_get_info *recorded = (const void *)record->args;
+		struct fw_cdev_get_info *info = args;
+		const guint8 *extra = record->args + size;
+		guint32 rom_length;
+
+		if (header->length < sizeof(*record) + size + sizeof(rom_length))
+			return -EINVAL;
+		memcpy(&rom_length, extra, sizeof(rom_length));
+		extra += sizeof(rom_length);
+		if (header->length < sizeof(*record) + size + sizeof(rom_length) + rom_length +
+				     sizeof(struct fw_cdev_event_bus_reset))
+			return -EINVAL;
+
+		associate_closure(rep, recorded->bus_reset_closure, info->bus_reset_closure);
+
+		if (info->rom != 0)
+			memcpy((void *)info->rom, extra, MIN(info->rom_length, rom_length));
+		info->rom_length = recorded->rom_length;
+		extra += rom_length;
+
+		if (info->bus_reset != 0) {
+			struct fw_cdev_event_bus_reset *bus_reset = (void *)info->bus_reset;
+
+			memcpy(bus_reset, extra, sizeof(*bus_reset));
+			bus_reset->closure = info->bus_reset_closure;
+		}
+
+		info->version = recorded->version;
+		info->card = recorded->card;
+		break;
+	}
+	case FW_CDEV_IOC_ALLOCATE:
+	{
+		const struct fw_cdev_allocate *recorded = (const void *)record->args;
+		struct fw_cdev_allocate *allocate = args;
+
+		associate_closure(rep, recorded->closure, allocate->closure);
+		allocate->offset = recorded->offset;
+		allocate->handle = recorded->handle;
+		break;
+	}
+	case FW_CDEV_IOC_SEND_REQUEST:
+	{
+		const struct fw_cdev_send_request *recorded = (const void *)record->args;
+		const struct fw_cdev_send_request *request = args;
+
+		associate_closure(rep, recorded->closure, request->closure);
+		break;
+	}
+	case FW_CDEV_IOC_GET_CYCLE_TIMER2:
+	{
+		struct fw_cdev_get_cycle_timer2 *timer = args;
+		gint32 clk_id = timer->clk_id;
+
+		memcpy(timer, record->args, size);
+		timer->clk_id = clk_id;
+		break;
+	}
+	default:
+		break;
+	}
+
+	return record->result < 0 ? -record->err : 0;
+}
+
+static int replay_ioctl(int fd, unsigned long req, void *args, gpointer data)
+{
+	struct replayer *rep = data;
+	const struct record_header *header = NULL;
+	int result;
+
+	g_mutex_lock(&rep->mutex);
+
+	// Wait for the preceding events to be delivered.
+	while (rep->running && rep->next < rep->records->len) {
+		header = get_record(rep, rep->next);
+		if (header->type == RECORD_TYPE_IOCTL)
+			break;
+		header = NULL;
+		g_cond_wait(&rep->cond, &rep->mutex);
+	}
+
+	if (header != NULL && ((const struct record_ioctl *)(header + 1))->req == req) {
+		result = replay_record_ioctl(rep, header, req, args);
+		++rep->next;
+		g_cond_broadcast(&rep->cond);
+	} else {
+		// The replay diverges from the record.
+		result = -EPROTO;
+	}
+
+	g_mutex_unlock(&rep->mutex);
+
+	if (result < 0) {
+		errno = -result;
+		return -1;
+	}
+
+	return 0;
+}
+
+static ssize_t replay_read(int fd, void *buf, size_t length, gpointer data)
+{
+	struct replayer *rep = data;
+	const struct record_header *header;
+	union fw_cdev_event *event = buf;
+	const gint64 *live;
+	eventfd_t val;
+	gsize size;
+
+	g_mutex_lock(&rep->mutex);
+
+	header = g_queue_pop_head(&rep->ready);
+	if (header == NULL) {
+		g_mutex_unlock(&rep->mutex);
+		errno = EAGAIN;
+		return -1;
+	}
+	eventfd_read(fd, &val);
+
+	size = MIN(header->length, length);
+	memcpy(buf, header + 1, size);
+
+	// The event for the closure not associated yet is dropped by the node.
+	live = g_hash_table_lookup(rep->closures, &event->common.closure);
+	event->common.closure = live != NULL ? *live : 0;
+
+	g_mutex_unlock(&rep->mutex);
+
+	return size;
+}
+
+// The backend to replay the record.
+const struct hinawa_fw_node_backend hinawa_fw_node_replay_backend = {
+	.open	= replay_open,
+	.close	= replay_close,
+	.ioctl	= replay_ioctl,
+	.read	= replay_read,
+};
+
+gboolean hinawa_fw_node_replay_path(const char *path)
+{
+	return g_str_has_prefix(path, REPLAY_PATH_PREFIX) ||
+	       g_str_has_prefix(path, REPLAY_FAST_PATH_PREFIX);
+}
@@ -0,0 +1,729 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+#include "internal.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+// The simulated bus consists of the local node and a remote node. The request to the range of
+// address allocated by FW_CDEV_IOC_ALLOCATE is delivered back to the local node as the event of
+// request, then the response sent by FW_CDEV_IOC_SEND_RESPONSE is delivered as the event of
+// response. The request to the other address is handled by the remote node with flat memory
+// which the lower bits of address points to. The memory includes the configuration ROM at
+// 0x400.
+//
+// The behaviour is configured by the options after the colon of path, separated by comma:
+//
+//   latency=N:	deliver events N microseconds later. The bare number is also the latency.
+//   busy=N:	respond with RCODE_BUSY to every N-th request to the remote node.
+//   reset=N:	generate bus reset every N milliseconds.
+//   fcp:	respond to the AV/C command written to FCP command register by writing AV/C
+//		response to FCP response register of local node.
+//   fcp=interim:	same as the above, with AV/C INTERIM response in advance.
+
+#define SIM_MEMORY_SIZE		0x10000
+#define SIM_CONFIG_ROM_OFFSET	0x400
+#define SIM_LOCAL_NODE_ID	0xffc0
+#define SIM_REMOTE_NODE_ID	0xffc1
+#define SIM_INITIAL_GENERATION	1
+
+#define CSR_REGISTER_BASE	0xfffff0000000ULL
+#define CSR_FCP_COMMAND		0x0b00
+#define CSR_FCP_RESPONSE	0x0d00
+#define CSR_FCP_SIZE		0x200
+
+// The code of AV/C ctype and response.
+#define AVC_CTYPE_CONTROL		0x00
+#define AVC_CTYPE_STATUS		0x01
+#define AVC_RESPONSE_NOT_IMPLEMENTED	0x08
+#define AVC_RESPONSE_ACCEPTED		0x09
+#define AVC_RESPONSE_STABLE		0x0c
+#define AVC_RESPONSE_INTERIM		0x0f
+
+// Configuration ROM of the remote node in host-endian, as Linux FireWire subsystem caches.
+static const guint32 sim_config_rom[] = {
+	0x04070000,	// bus info length 4, CRC length 7.
+	0x31333934,	// '1394'.
+	0xf000a002,	// Capable of IRM, CMC, ISC, BMC, max_rec 2048 bytes.
+	0x0001f200,	// GUID high.
+	0x00000001,	// GUID low.
+	0x00020000,	// Root directory with 2 entries.
+	0x03001f11,	// Vendor ID.
+	0x17000001,	// Model ID.
+};
+
+struct sim_region {
+	guint64 offset;
+	guint64 end;
+	guint64 closure;
+	guint32 handle;
+};
+
+struct sim_inbound {
+	guint64 closure;
+	guint32 tcode;
+	guint32 length;
+};
+
+struct sim_delivery {
+	gint64 due;
+	GBytes *event;
+};
+
+enum sim_fcp_mode {
+	SIM_FCP_MODE_NONE = 0,
+	SIM_FCP_MODE_FINAL,
+	SIM_FCP_MODE_INTERIM,
+};
+
+struct sim_bus {
+	int fd;
+	gint64 latency;
+	guint busy_interval;
+	gint64 reset_interval;
+	enum sim_fcp_mode fcp_mode;
+
+	GMutex mutex;
+	GCond cond;
+	GQueue ready;
+	GQueue pending;
+	GThread *thread;
+	gboolean running;
+
+	GList *regions;
+	GHashTable *inbounds;
+	guint32 next_handle;
+	guint64 bus_reset_closure;
+	guint32 generation;
+	guint requests;
+	gint64 next_reset;
+
+	guint8 memory[SIM_MEMORY_SIZE];
+};
+
+// Should be called with the mutex. The eventfd_write() is used instead of write(2) so that the
+// shim interposing the system calls does not catch it.
+static void notify_ready(struct sim_bus *bus, GBytes *event)
+{
+	g_queue_push_tail(&bus->ready, event);
+	eventfd_write(bus->fd, 1);
+}
+
+static void fill_bus_reset(struct sim_bus *bus, struct fw_cdev_event_bus_reset *event)
+{
+	event->closure = bus->bus_reset_closure;
+	event->type = FW_CDEV_EVENT_BUS_RESET;
+	event->node_id = SIM_REMOTE_NODE_ID;
+	event->local_node_id = SIM_LOCAL_NODE_ID;
+	event->bm_node_id = SIM_LOCAL_NODE_ID;
+	event->irm_node_id = SIM_LOCAL_NODE_ID;
+	event->root_node_id = SIM_REMOTE_NODE_ID;
+	event->generation = bus->generation;
+}
+
+// Should be called with the mutex. The events queued already are delivered as is.
+static void generate_bus_reset(struct sim_bus *bus)
+{
+	struct fw_cdev_event_bus_reset *event = g_new0(struct fw_cdev_event_bus_reset, 1);
+
+	++bus->generation;
+	fill_bus_reset(bus, event);
+	notify_ready(bus, g_bytes_new_take(event, sizeof(*event)));
+}
+
+// Should be called with the mutex.
+static void deliver_event(struct sim_bus *bus, GBytes *event)
+{
+	struct sim_delivery *delivery;
+
+	if (bus->latency == 0) {
+		notify_ready(bus, event);
+		return;
+	}
+
+	// The latency is constant, thus the queue is sorted by the time to deliver.
+	delivery = g_new(struct sim_delivery, 1);
+	delivery->due = g_get_monotonic_time() + bus->latency;
+	delivery->event = event;
+	g_queue_push_tail(&bus->pending, delivery);
+	g_cond_signal(&bus->cond);
+}
+
+static gpointer run_delivery(gpointer data)
+{
+	struct sim_bus *bus = data;
+
+	g_mutex_lock(&bus->mutex);
+
+	while (bus->running) {
+		struct sim_delivery *delivery = g_queue_peek_head(&bus->pending);
+		gint64 now = g_get_monotonic_time();
+		gint64 deadline = G_MAXINT64;
+
+		if (bus->reset_interval > 0) {
+			if (now >= bus->next_reset) {
+				generate_bus_reset(bus);
+				bus->next_reset = now + bus->reset_interval;
+			}
+			deadline = bus->next_reset;
+		}
+
+		if (delivery != NULL && now >= delivery->due) {
+			g_queue_pop_head(&bus->pending);
+			notify_ready(bus, delivery->event);
+			g_free(delivery);
+			continue;
+		}
+
+		if (delivery != NULL)
+			deadline = MIN(deadline, delivery->due);
+		if (deadline == G_MAXINT64)
+			g_cond_wait(&bus->cond, &bus->mutex);
+		else
+			g_cond_wait_until(&bus->cond, &bus->mutex, deadline);
+	}
+
+	g_mutex_unlock(&bus->mutex);
+
+	return NULL;
+}
+
+// The whole key should match.
+static gboolean match_key(const gchar *token, gsize length, const gchar *key)
+{
+	return length == strlen(key) && strncmp(token, key, length) == 0;
+}
+
+// The whole value should be decimal number in the range.
+static gboolean parse_number(const gchar *value, gint64 max, gint64 *number)
+{
+	gchar *end;
+
+	if (value == NULL || *value == '\0')
+		return FALSE;
+
+	errno = 0;
+	*number = g_ascii_strtoll(value, &end, 10);
+
+	return errno == 0 && *end == '\0' && *number >= 0 && *number <= max;
+}
+
+static gboolean parse_options(struct sim_bus *bus, const char *options)
+{
+	gchar **tokens = g_strsplit(options, ",", -1);
+	gboolean result = TRUE;
+	int i;
+
+	for (i = 0; tokens[i] != NULL && result; ++i) {
+		const gchar *token = tokens[i];
+		const gchar *value = strchr(token, '=');
+		gsize length = value != NULL ? value - token : strlen(token);
+		gint64 number = 0;
+
+		if (value != NULL)
+			++value;
+
+		if (length == 0) {
+			continue;
+		} else if (g_ascii_isdigit(token[0])) {
+			result = parse_number(token, G_MAXINT64, &bus->latency);
+		} else if (match_key(token, length, "latency")) {
+			result = parse_number(value, G_MAXINT64, &bus->latency);
+		} else if (match_key(token, length, "busy")) {
+			result = parse_number(value, G_MAXUINT, &number);
+			bus->busy_interval = (guint)number;
+		} else if (match_key(token, length, "reset")) {
+			result = parse_number(value, G_MAXINT64 / G_TIME_SPAN_MILLISECOND, &number);
+			bus->reset_interval = number * G_TIME_SPAN_MILLISECOND;
+		} else if (match_key(token, length, "fcp")) {
+			if (value == NULL)
+				bus->fcp_mode = SIM_FCP_MODE_FINAL;
+			else if (strcmp(value, "interim") == 0)
+				bus->fcp_mode = SIM_FCP_MODE_INTERIM;
+			else
+				result = FALSE;
+		} else {
+			result = FALSE;
+		}
+	}
+
+	g_strfreev(tokens);
+
+	return result;
+}
+
+static int sim_open(const char *path, int flags, gpointer *data)
+{
+	const char *options = strchr(path, ':');
+	struct sim_bus *bus;
+	int fd;
+	int i;
+
+	bus = g_new0(struct sim_bus, 1);
+	if (options != NULL && !parse_options(bus, options + 1)) {
+		g_free(bus);
+		errno = EINVAL;
+		return -1;
+	}
+
+	// The counter of eventfd is the number of events ready to read.
+	fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+	if (fd < 0) {
+		g_free(bus);
+		return -1;
+	}
+	bus->fd = fd;
+	bus->generation = SIM_INITIAL_GENERATION;
+
+	for (i = 0; i < G_N_ELEMENTS(sim_config_rom); ++i) {
+		guint32 quad = GUINT32_TO_BE(sim_config_rom[i]);
+
+		memcpy(bus->memory + SIM_CONFIG_ROM_OFFSET + i * 4, &quad, 4);
+	}
+
+	g_mutex_init(&bus->mutex);
+	g_cond_init(&bus->cond);
+	g_queue_init(&bus->ready);
+	g_queue_init(&bus->pending);
+	bus->inbounds = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	bus->next_handle = 1;
+
+	if (bus->latency > 0 || bus->reset_interval > 0) {
+		bus->next_reset = g_get_monotonic_time() + bus->reset_interval;
+		bus->running = TRUE;
+		bus->thread = g_thread_new("hinawa-sim-bus", run_delivery, bus);
+	}
+
+	*data = bus;
+
+	return fd;
+}
+
+static void sim_close(int fd, gpointer data)
+{
+	struct sim_bus *bus = data;
+	struct sim_delivery *delivery;
+	GBytes *event;
+
+	if (bus->thread != NULL) {
+		g_mutex_lock(&bus->mutex);
+		bus->running = FALSE;
+		g_cond_signal(&bus->cond);
+		g_mutex_unlock(&bus->mutex);
+		g_thread_join(bus->thread);
+	}
+
+	while ((delivery = g_queue_pop_head(&bus->pending)) != NULL) {
+		g_bytes_unref(delivery->event);
+		g_free(delivery);
+	}
+	while ((event = g_queue_pop_head(&bus->ready)) != NULL)
+		g_bytes_unref(event);
+
+	g_list_free_full(bus->regions, g_free);
+	g_hash_table_unref(bus->inbounds);
+	g_cond_clear(&bus->cond);
+	g_mutex_clear(&bus->mutex);
+	g_free(bus);
+
+	close(fd);
+}
+
+static ssize_t sim_read(int fd, void *buf, size_t length, gpointer data)
+{
+	struct sim_bus *bus = data;
+	GBytes *event;
+	eventfd_t val;
+	gconstpointer content;
+	gsize size;
+
+	g_mutex_lock(&bus->mutex);
+	event = g_queue_pop_head(&bus->ready);
+	if (event != NULL)
+		eventfd_read(fd, &val);
+	g_mutex_unlock(&bus->mutex);
+
+	if (event == NULL) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	content = g_bytes_get_data(event, &size);
+	size = MIN(size, length);
+	memcpy(buf, content, size);
+	g_bytes_unref(event);
+
+	return size;
+}
+
+static int get_info(struct sim_bus *bus, struct fw_cdev_get_info *info)
+{
+	if (info->rom != 0) {
+		memcpy((void *)info->rom, sim_config_rom,
+		       MIN(info->rom_length, sizeof(sim_config_rom)));
+	}
+	info->rom_length = sizeof(sim_config_rom);
+
+	bus->bus_reset_closure = info->bus_reset_closure;
+	if (info->bus_reset != 0)
+		fill_bus_reset(bus, (struct fw_cdev_event_bus_reset *)info->bus_reset);
+
+	info->card = 0;
+
+	return 0;
+}
+
+static int get_cycle_timer2(struct fw_cdev_get_cycle_timer2 *timer)
+{
+	struct timespec ts;
+	guint64 ticks;
+	guint64 cycles;
+
+	if (clock_gettime(timer->clk_id, &ts) < 0)
+		return -1;
+	timer->tv_sec = ts.tv_sec;
+	timer->tv_nsec = ts.tv_nsec;
+
+	// The cycle timer counts 24.576 MHz clock; 3072 ticks per cycle, 8000 cycles per second.
+	ticks = ((guint64)ts.tv_sec * 1000000000 + ts.tv_nsec) * 24576 / 1000000;
+	cycles = ticks / 3072;
+	timer->cycle_timer = (((cycles / 8000) % 128) << 25) | ((cycles % 8000) << 12) |
+			     (ticks % 3072);
+
+	return 0;
+}
+
+static struct sim_region *find_region(struct sim_bus *bus, guint64 offset, guint64 end)
+{
+	GList *entry;
+
+	for (entry = bus->regions; entry != NULL; entry = entry->next) {
+		struct sim_region *region = entry->data;
+
+		if (offset < region->end && region->offset < end)
+			return region;
+	}
+
+	return NULL;
+}
+
+static int allocate(struct sim_bus *bus, struct fw_cdev_allocate *allocate)
+{
+	guint64 offset = allocate->offset;
+	guint64 region_end = MAX(allocate->region_end, allocate->offset + allocate->length);
+	struct sim_region *region;
+
+	if (allocate->length == 0 || (offset & 0x3) || (allocate->length & 0x3)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	while (offset + allocate->length <= region_end) {
+		struct sim_region *used = find_region(bus, offset, offset + allocate->length);
+
+		if (used == NULL)
+			break;
+		offset = used->end;
+	}
+	if (offset + allocate->length > region_end) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	region = g_new(struct sim_region, 1);
+	region->offset = offset;
+	region->end = offset + allocate->length;
+	region->closure = allocate->closure;
+	region->handle = bus->next_handle++;
+	bus->regions = g_list_append(bus->regions, region);
+
+	allocate->offset = offset;
+	allocate->handle = region->handle;
+
+	return 0;
+}
+
+static int deallocate(struct sim_bus *bus, const struct fw_cdev_deallocate *deallocate)
+{
+	GList *entry;
+
+	for (entry = bus->regions; entry != NULL; entry = entry->next) {
+		struct sim_region *region = entry->data;
+
+		if (region->handle == deallocate->handle) {
+			bus->regions = g_list_delete_link(bus->regions, entry);
+			g_free(region);
+			return 0;
+		}
+	}
+
+	errno = EINVAL;
+	return -1;
+}
+
+static GBytes *build_response(guint64 closure, guint32 rcode, const guint8 *data, guint32 length)
+{
+	struct fw_cdev_event_response2 *event;
+	gsize size = sizeof(*event) + length;
+
+	event = g_malloc0(size);
+	event->closure = closure;
+	event->type = FW_CDEV_EVENT_RESPONSE2;
+	event->rcode = rcode;
+	event->length = length;
+	event->request_tstamp = 0;
+	event->response_tstamp = 0;
+	if (length > 0)
+		memcpy(event->data, data, length);
+
+	return g_bytes_new_take(event, size);
+}
+
+// The remote node operates the flat memory. The lock request supports compare-swap and
+// fetch-add only.
+static guint32 operate_memory(struct sim_bus *bus, guint32 tcode, guint64 offset,
+			      const guint8 *data, guint32 length, guint8 *frame,
+			      guint32 *frame_length)
+{
+	guint8 *mem = bus->memory + (offset & (SIM_MEMORY_SIZE - 1));
+	guint32 arg_length;
+
+	*frame_length = 0;
+
+	if ((offset & (SIM_MEMORY_SIZE - 1)) + length > SIM_MEMORY_SIZE)
+		return RCODE_ADDRESS_ERROR;
+
+	switch (tcode) {
+	case TCODE_WRITE_QUADLET_REQUEST:
+	case TCODE_WRITE_BLOCK_REQUEST:
+		memcpy(mem, data, length);
+		return RCODE_COMPLETE;
+	case TCODE_READ_QUADLET_REQUEST:
+	case TCODE_READ_BLOCK_REQUEST:
+		memcpy(frame, mem, length);
+		*frame_length = length;
+		return RCODE_COMPLETE;
+	case TCODE_LOCK_COMPARE_SWAP:
+		arg_length = length / 2;
+		memcpy(frame, mem, arg_length);
+		*frame_length = arg_length;
+		if (memcmp(mem, data, arg_length) == 0)
+			memcpy(mem, data + arg_length, arg_length);
+		return RCODE_COMPLETE;
+	case TCODE_LOCK_FETCH_ADD:
+	{
+		guint64 val = 0;
+		guint64 arg = 0;
+		int i;
+
+		if (length != 4 && length != 8)
+			return RCODE_TYPE_ERROR;
+		memcpy(frame, mem, length);
+		*frame_length = length;
+		// Big-endian addition.
+		for (i = 0; i < length; ++i) {
+			val = (val << 8) | mem[i];
+			arg = (arg << 8) | data[i];
+		}
+		val += arg;
+		for (i = length - 1; i >= 0; --i) {
+			mem[i] = val & 0xff;
+			val >>= 8;
+		}
+		return RCODE_COMPLETE;
+	}
+	default:
+		return RCODE_TYPE_ERROR;
+	}
+}
+
+// Deliver the request to the range allocated by the local node. The closure of requester is zero
+// when the request comes from the remote node.
+static void deliver_request(struct sim_bus *bus, const struct sim_region *region,
+			    guint64 requester, guint32 source_node_id, guint32 tcode,
+			    guint64 offset, const guint8 *data, guint32 length)
+{
+	struct fw_cdev_event_request3 *event;
+	struct sim_inbound *inbound;
+	guint32 payload_length;
+	gsize size;
+
+	// The request to read has no payload.
+	if (tcode == TCODE_READ_QUADLET_REQUEST || tcode == TCODE_READ_BLOCK_REQUEST)
+		payload_length = 0;
+	else
+		payload_length = length;
+
+	inbound = g_new(struct sim_inbound, 1);
+	inbound->closure = requester;
+	inbound->tcode = tcode;
+	inbound->length = length;
+
+	size = sizeof(*event) + payload_length;
+	event = g_malloc0(size);
+	event->closure = region->closure;
+	event->type = FW_CDEV_EVENT_REQUEST3;
+	event->tcode = tcode;
+	event->offset = offset;
+	event->source_node_id = source_node_id;
+	event->destination_node_id = SIM_LOCAL_NODE_ID;
+	event->card = 0;
+	event->generation = bus->generation;
+	event->handle = bus->next_handle++;
+	event->length = length;
+	event->tstamp = 0;
+	if (payload_length > 0)
+		memcpy(event->data, data, payload_length);
+
+	g_hash_table_insert(bus->inbounds, GUINT_TO_POINTER(event->handle), inbound);
+	deliver_event(bus, g_bytes_new_take(event, size));
+}
+
+// Write AV/C response to FCP response register of local node.
+static void respond_fcp(struct sim_bus *bus, const guint8 *cmd, guint32 length)
+{
+	guint64 offset = CSR_REGISTER_BASE + CSR_FCP_RESPONSE;
+	const struct sim_region *region;
+	guint8 *frame;
+
+	region = find_region(bus, offset, offset + length);
+	if (region == NULL)
+		return;
+
+	frame = g_malloc(length);
+	memcpy(frame, cmd, length);
+
+	if (bus->fcp_mode == SIM_FCP_MODE_INTERIM) {
+		frame[0] = AVC_RESPONSE_INTERIM;
+		deliver_request(bus, region, 0, SIM_REMOTE_NODE_ID, TCODE_WRITE_BLOCK_REQUEST,
+				offset, frame, length);
+	}
+
+	switch (cmd[0] & 0x0f) {
+	case AVC_CTYPE_CONTROL:
+		frame[0] = AVC_RESPONSE_ACCEPTED;
+		break;
+	case AVC_CTYPE_STATUS:
+		frame[0] = AVC_RESPONSE_STABLE;
+		break;
+	default:
+		frame[0] = AVC_RESPONSE_NOT_IMPLEMENTED;
+		break;
+	}
+	deliver_request(bus, region, 0, SIM_REMOTE_NODE_ID, TCODE_WRITE_BLOCK_REQUEST, offset,
+			frame, length);
+
+	g_free(frame);
+}
+
+static int send_request(struct sim_bus *bus, const struct fw_cdev_send_request *req)
+{
+	const guint8 *data = (const guint8 *)req->data;
+	struct sim_region *region;
+	guint8 *frame;
+	guint32 frame_length;
+	guint32 rcode;
+
+	if (req->generation != bus->generation) {
+		deliver_event(bus, build_response(req->closure, RCODE_GENERATION, NULL, 0));
+		return 0;
+	}
+
+	// The request to the range allocated by the local node.
+	region = find_region(bus, req->offset, req->offset + MAX(req->length, 1));
+	if (region != NULL) {
+		deliver_request(bus, region, req->closure, SIM_LOCAL_NODE_ID, req->tcode,
+				req->offset, data, req->length);
+		return 0;
+	}
+
+	++bus->requests;
+	if (bus->busy_interval > 0 && bus->requests % bus->busy_interval == 0) {
+		deliver_event(bus, build_response(req->closure, RCODE_BUSY, NULL, 0));
+		return 0;
+	}
+
+	if (bus->fcp_mode != SIM_FCP_MODE_NONE && req->tcode == TCODE_WRITE_BLOCK_REQUEST &&
+	    req->offset == CSR_REGISTER_BASE + CSR_FCP_COMMAND &&
+	    req->length > 0 && req->length <= CSR_FCP_SIZE) {
+		deliver_event(bus, build_response(req->closure, RCODE_COMPLETE, NULL, 0));
+		respond_fcp(bus, data, req->length);
+		return 0;
+	}
+
+	frame = g_malloc(MAX(req->length, 1));
+	rcode = operate_memory(bus, req->tcode, req->offset, data, req->length, frame,
+			       &frame_length);
+	deliver_event(bus, build_response(req->closure, rcode, frame, frame_length));
+	g_free(frame);
+
+	return 0;
+}
+
+static int send_response(struct sim_bus *bus, const struct fw_cdev_send_response *resp)
+{
+	struct sim_inbound *inbound;
+
+	inbound = g_hash_table_lookup(bus->inbounds, GUINT_TO_POINTER(resp->handle));
+	if (inbound == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	// The response to the remote node is just discarded.
+	if (inbound->closure != 0) {
+		deliver_event(bus, build_response(inbound->closure, resp->rcode,
+						  (const guint8 *)resp->data, resp->length));
+	}
+	g_hash_table_remove(bus->inbounds, GUINT_TO_POINTER(resp->handle));
+
+	return 0;
+}
+
+static int sim_ioctl(int fd, unsigned long req, void *args, gpointer data)
+{
+	struct sim_bus *bus = data;
+	int result;
+
+	g_mutex_lock(&bus->mutex);
+
+	switch (req) {
+	case FW_CDEV_IOC_GET_INFO:
+		result = get_info(bus, args);
+		break;
+	case FW_CDEV_IOC_GET_CYCLE_TIMER2:
+		result = get_cycle_timer2(args);
+		break;
+	case FW_CDEV_IOC_ALLOCATE:
+		result = allocate(bus, args);
+		break;
+	case FW_CDEV_IOC_DEALLOCATE:
+		result = deallocate(bus, args);
+		break;
+	case FW_CDEV_IOC_SEND_REQUEST:
+		result = send_request(bus, args);
+		break;
+	case FW_CDEV_IOC_SEND_RESPONSE:
+		result = send_response(bus, args);
+		break;
+	default:
+		errno = ENOTTY;
+		result = -1;
+		break;
+	}
+
+	g_mutex_unlock(&bus->mutex);
+
+	return result;
+}
+
+// The backend for the simulated bus in the process.
+const struct hinawa_fw_node_backend hinawa_fw_node_sim_backend = {
+	.open	= sim_open,
+	.close	= sim_close,
+	.ioctl	= sim_ioctl,
+	.read	= sim_read,
+};
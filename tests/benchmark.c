@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// The benchmark of transaction, responder, and FCP paths against the bus simulated in the process.
+// Each result is printed in a line of JSON object so that regressions can be tracked:
+//
+//   {"benchmark": "transaction", "metric": "rate", "value": 123456.0, "unit": "ops/s"}
+#include <hinawa.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_ITERATIONS	10000
+#define TIMEOUT_MS		100
+
+#define SIM_MEMORY_ADDR		0xfffff0000900
+#define RESP_ADDR		0xfffff0001000
+#define RESP_WIDTH		0x100
+
+// The allocations in the process are counted by interposing malloc family of glibc.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static gint allocations;
+
+void *malloc(size_t size)
+{
+	g_atomic_int_inc(&allocations);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	g_atomic_int_inc(&allocations);
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	g_atomic_int_inc(&allocations);
+	return __libc_realloc(ptr, size);
+}
+
+static void print_result(const char *benchmark, const char *metric, double value,
+			 const char *unit)
+{
+	printf("{\"benchmark\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}\n",
+	       benchmark, metric, value, unit);
+}
+
+static int compare_span(const void *a, const void *b)
+{
+	gint64 lhs = *(const gint64 *)a;
+	gint64 rhs = *(const gint64 *)b;
+
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+static void print_latencies(const char *benchmark, gint64 *spans, guint count)
+{
+	gint64 total = 0;
+	guint i;
+
+	for (i = 0; i < count; ++i)
+		total += spans[i];
+
+	qsort(spans, count, sizeof(*spans), compare_span);
+
+	print_result(benchmark, "rate", count * (double)G_USEC_PER_SEC / MAX(total, 1), "ops/s");
+	print_result(benchmark, "latency-mean", (double)total / count, "us");
+	print_result(benchmark, "latency-p50", spans[count / 2], "us");
+	print_result(benchmark, "latency-p99", spans[count * 99 / 100], "us");
+}
+
+static HinawaFwNode *open_node(const char *path, gboolean dispatcher)
+{
+	HinawaFwNode *node = hinawa_fw_node_new();
+	GError *error = NULL;
+
+	if (!hinawa_fw_node_open(node, path, 0, &error) ||
+	    (dispatcher && !hinawa_fw_node_launch_dispatcher(node, 0, -1, &error))) {
+		g_printerr("%s: %s\n", path, error->message);
+		exit(EXIT_FAILURE);
+	}
+
+	return node;
+}
+
+static void close_node(HinawaFwNode *node)
+{
+	hinawa_fw_node_terminate_dispatcher(node);
+	g_object_unref(node);
+}
+
+static gboolean run_transaction(HinawaFwReq *req, HinawaFwNode *node, guint64 addr)
+{
+	guint8 buf[4] = {0};
+	guint8 *frame = buf;
+	gsize frame_size = sizeof(buf);
+	GError *error = NULL;
+
+	if (!hinawa_fw_req_transaction(req, node, HINAWA_FW_TCODE_READ_QUADLET_REQUEST, addr,
+				       sizeof(buf), &frame, &frame_size, TIMEOUT_MS, &error)) {
+		g_printerr("transaction: %s\n", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+// Synchronous round trips of transaction to the memory of simulated node.
+static int bench_transaction(guint iterations)
+{
+	HinawaFwNode *node = open_node("sim", TRUE);
+	HinawaFwReq *req = hinawa_fw_req_new();
+	gint64 *spans = g_new(gint64, iterations);
+	guint i;
+
+	for (i = 0; i < iterations; ++i) {
+		gint64 begin = g_get_monotonic_time();
+
+		if (!run_transaction(req, node, SIM_MEMORY_ADDR))
+			return EXIT_FAILURE;
+		spans[i] = g_get_monotonic_time() - begin;
+	}
+
+	print_latencies("transaction", spans, iterations);
+
+	g_free(spans);
+	g_object_unref(req);
+	close_node(node);
+
+	return EXIT_SUCCESS;
+}
+
+static void handle_responded(HinawaFwReq *req, HinawaFwRcode rcode, guint request_tstamp,
+			     guint response_tstamp, const guint8 *frame, guint frame_size,
+			     gpointer user_data)
+{
+	guint *count = user_data;
+
+	++(*count);
+}
+
+// The throughput to dispatch events, with the number of transactions in flight.
+static int bench_dispatch(guint iterations)
+{
+	static const guint depths[] = { 1, 16, 256, 4096 };
+	HinawaFwNode *node = open_node("sim", FALSE);
+	GMainContext *ctx = g_main_context_new();
+	GSource *src;
+	GError *error = NULL;
+	guint i;
+
+	// Drain queued events in a dispatch.
+	g_object_set(node, "dispatch-event-budget", 0, NULL);
+
+	if (!hinawa_fw_node_create_source(node, &src, &error)) {
+		g_printerr("source: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	g_source_attach(src, ctx);
+
+	for (i = 0; i < G_N_ELEMENTS(depths); ++i) {
+		guint depth = depths[i];
+		HinawaFwReq **reqs = g_new(HinawaFwReq *, depth);
+		guint rounds = MAX(iterations / depth, 1);
+		guint8 buf[4];
+		gint64 total = 0;
+		guint round;
+		guint j;
+		char name[32];
+
+		for (j = 0; j < depth; ++j)
+			reqs[j] = hinawa_fw_req_new();
+
+		for (round = 0; round < rounds; ++round) {
+			guint count = 0;
+			gint64 begin;
+
+			// The events are queued at the request in the simulated bus.
+			for (j = 0; j < depth; ++j) {
+				guint8 *frame = buf;
+				gsize frame_size = sizeof(buf);
+
+				g_signal_connect(reqs[j], "responded", G_CALLBACK(handle_responded),
+						 &count);
+				if (!hinawa_fw_req_request(reqs[j], node,
+							   HINAWA_FW_TCODE_READ_QUADLET_REQUEST,
+							   SIM_MEMORY_ADDR, sizeof(buf), &frame,
+							   &frame_size, &error)) {
+					g_printerr("request: %s\n", error->message);
+					return EXIT_FAILURE;
+				}
+			}
+
+			begin = g_get_monotonic_time();
+			while (count < depth)
+				g_main_context_iteration(ctx, TRUE);
+			total += g_get_monotonic_time() - begin;
+
+			for (j = 0; j < depth; ++j) {
+				g_signal_handlers_disconnect_by_func(reqs[j], handle_responded,
+								     &count);
+			}
+		}
+
+		g_snprintf(name, sizeof(name), "dispatch-inflight-%u", depth);
+		print_result(name, "rate", (double)depth * rounds * G_USEC_PER_SEC / MAX(total, 1),
+			     "events/s");
+
+		for (j = 0; j < depth; ++j)
+			g_object_unref(reqs[j]);
+		g_free(reqs);
+	}
+
+	g_source_destroy(src);
+	g_source_unref(src);
+	g_main_context_unref(ctx);
+	g_object_unref(node);
+
+	return EXIT_SUCCESS;
+}
+
+static HinawaFwRcode handle_requested(HinawaFwResp *resp, HinawaFwTcode tcode, guint64 offset,
+				      guint src_node_id, guint dst_node_id, guint card_id,
+				      guint generation, guint tstamp, const guint8 *frame,
+				      guint length, gpointer user_data)
+{
+	static guint8 quadlet[4] = { 0x01, 0x23, 0x45, 0x67 };
+
+	if (tcode == HINAWA_FW_TCODE_READ_QUADLET_REQUEST)
+		hinawa_fw_resp_set_resp_frame(resp, quadlet, sizeof(quadlet));
+
+	return HINAWA_FW_RCODE_COMPLETE;
+}
+
+// The round trip of transaction to the responder in the local node, by the signal or the function
+// called directly.
+static int bench_responder(const char *name, gboolean direct, guint iterations)
+{
+	HinawaFwNode *node = open_node("sim", TRUE);
+	HinawaFwResp *resp = hinawa_fw_resp_new();
+	HinawaFwReq *req = hinawa_fw_req_new();
+	gint64 *spans = g_new(gint64, iterations);
+	GError *error = NULL;
+	guint i;
+
+	if (!hinawa_fw_resp_reserve(resp, node, RESP_ADDR, RESP_WIDTH, &error)) {
+		g_printerr("reserve: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	if (direct)
+		hinawa_fw_resp_set_requested_func(resp, handle_requested, NULL, NULL);
+	else
+		g_signal_connect(resp, "requested", G_CALLBACK(handle_requested), NULL);
+
+	for (i = 0; i < iterations; ++i) {
+		gint64 begin = g_get_monotonic_time();
+
+		if (!run_transaction(req, node, RESP_ADDR))
+			return EXIT_FAILURE;
+		spans[i] = g_get_monotonic_time() - begin;
+	}
+
+	print_latencies(name, spans, iterations);
+
+	g_free(spans);
+	g_object_unref(req);
+	hinawa_fw_resp_release(resp);
+	g_object_unref(resp);
+	close_node(node);
+
+	return EXIT_SUCCESS;
+}
+
+// AV/C transaction in FCP, with or without INTERIM response.
+static int bench_fcp(const char *name, const char *path, guint iterations)
+{
+	// AV/C UNIT INFO command.
+	static const guint8 cmd[] = { 0x01, 0xff, 0x30, 0xff, 0xff, 0xff, 0xff, 0xff };
+	HinawaFwNode *node = open_node(path, TRUE);
+	HinawaFwFcp *fcp = hinawa_fw_fcp_new();
+	gint64 *spans = g_new(gint64, iterations);
+	GError *error = NULL;
+	guint i;
+
+	if (!hinawa_fw_fcp_bind(fcp, node, &error)) {
+		g_printerr("bind: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < iterations; ++i) {
+		guint8 buf[sizeof(cmd)];
+		guint8 *resp = buf;
+		gsize resp_size = sizeof(buf);
+		gint64 begin = g_get_monotonic_time();
+
+		if (!hinawa_fw_fcp_avc_transaction(fcp, cmd, sizeof(cmd), &resp, &resp_size,
+						   TIMEOUT_MS, &error)) {
+			g_printerr("avc_transaction: %s\n", error->message);
+			return EXIT_FAILURE;
+		}
+		spans[i] = g_get_monotonic_time() - begin;
+	}
+
+	print_latencies(name, spans, iterations);
+
+	g_free(spans);
+	hinawa_fw_fcp_unbind(fcp);
+	g_object_unref(fcp);
+	close_node(node);
+
+	return EXIT_SUCCESS;
+}
+
+// The number of allocations per synchronous transaction.
+static int bench_allocations(guint iterations)
+{
+	HinawaFwNode *node = open_node("sim", TRUE);
+	HinawaFwReq *req = hinawa_fw_req_new();
+	gint begin;
+	guint i;
+
+	// Warm up.
+	if (!run_transaction(req, node, SIM_MEMORY_ADDR))
+		return EXIT_FAILURE;
+
+	begin = g_atomic_int_get(&allocations);
+	for (i = 0; i < iterations; ++i) {
+		if (!run_transaction(req, node, SIM_MEMORY_ADDR))
+			return EXIT_FAILURE;
+	}
+
+	print_result("allocations", "per-transaction",
+		     (double)(g_atomic_int_get(&allocations) - begin) / iterations, "calls");
+
+	g_object_unref(req);
+	close_node(node);
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	guint iterations = DEFAULT_ITERATIONS;
+	const char *name;
+
+	if (argc < 2) {
+		g_printerr("Usage: %s transaction|dispatch|responder|responder-func|fcp|fcp-interim|"
+			   "allocations [ITERATIONS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	name = argv[1];
+	if (argc > 2)
+		iterations = MAX(strtoul(argv[2], NULL, 10), 1);
+
+	if (strcmp(name, "transaction") == 0)
+		return bench_transaction(iterations);
+	else if (strcmp(name, "dispatch") == 0)
+		return bench_dispatch(iterations);
+	else if (strcmp(name, "responder") == 0)
+		return bench_responder(name, FALSE, iterations);
+	else if (strcmp(name, "responder-func") == 0)
+		return bench_responder(name, TRUE, iterations);
+	else if (strcmp(name, "fcp") == 0)
+		return bench_fcp("fcp", "sim:fcp", iterations);
+	else if (strcmp(name, "fcp-interim") == 0)
+		return bench_fcp("fcp-interim", "sim:fcp=interim", iterations);
+	else if (strcmp(name, "allocations") == 0)
+		return bench_allocations(iterations);
+
+	g_printerr("Unknown benchmark: %s\n", name);
+
+	return EXIT_FAILURE;
+}
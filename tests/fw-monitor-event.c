@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// The unit test of parser for inotify events in the directory of Linux FireWire character
+// devices, fed by the handcrafted buffer instead of the directory in the system.
+#include "internal.h"
+
+#include <string.h>
+#include <sys/inotify.h>
+
+static void test_device_name(void)
+{
+	g_assert_true(hinawa_monitor_event_is_device_name("fw0"));
+	g_assert_true(hinawa_monitor_event_is_device_name("fw12"));
+
+	g_assert_false(hinawa_monitor_event_is_device_name(""));
+	g_assert_false(hinawa_monitor_event_is_device_name("fw"));
+	g_assert_false(hinawa_monitor_event_is_device_name("fwa"));
+	g_assert_false(hinawa_monitor_event_is_device_name("fw1a"));
+	g_assert_false(hinawa_monitor_event_is_device_name("fw-1"));
+	g_assert_false(hinawa_monitor_event_is_device_name("firewire"));
+	g_assert_false(hinawa_monitor_event_is_device_name("snd"));
+}
+
+// The name is padded by null characters to the given length, which keeps the alignment of the
+// structure as the kernel does.
+static void append_event(GByteArray *buf, guint32 mask, const gchar *name, guint32 len)
+{
+	struct inotify_event event = { .wd = 1, .mask = mask, .len = len };
+	guint8 *padded = g_malloc0(len);
+
+	if (name != NULL)
+		memcpy(padded, name, MIN(strlen(name), len));
+
+	g_byte_array_append(buf, (const guint8 *)&event, sizeof(event));
+	g_byte_array_append(buf, padded, len);
+	g_free(padded);
+}
+
+static void record_event(const gchar *name, gboolean added, gpointer user_data)
+{
+	GString *log = user_data;
+
+	g_string_append_printf(log, "%c%s ", added ? '+' : '-', name);
+}
+
+static gchar *parse(const GByteArray *buf, gsize length)
+{
+	GString *log = g_string_new(NULL);
+
+	hinawa_monitor_event_parse(buf->data, length, record_event, log);
+
+	return g_string_free(log, FALSE);
+}
+
+static void test_parse(void)
+{
+	GByteArray *buf = g_byte_array_new();
+	gchar *log;
+
+	append_event(buf, IN_CREATE, "fw0", 16);
+	append_event(buf, IN_CREATE, "snd", 16);	// Not the character device.
+	append_event(buf, IN_DELETE, NULL, 0);		// No name.
+	append_event(buf, IN_MODIFY, "fw1", 16);	// Not watched.
+	append_event(buf, IN_DELETE, "fw12", 16);
+	append_event(buf, IN_CREATE, "fw34", 4);	// Not terminated by null character.
+	append_event(buf, IN_CREATE | IN_ISDIR, "fw4", 4);
+
+	log = parse(buf, buf->len);
+	g_assert_cmpstr(log, ==, "+fw0 -fw12 +fw4 ");
+	g_free(log);
+
+	// The truncated event is not parsed.
+	log = parse(buf, buf->len - 1);
+	g_assert_cmpstr(log, ==, "+fw0 -fw12 ");
+	g_free(log);
+
+	log = parse(buf, sizeof(struct inotify_event) - 1);
+	g_assert_cmpstr(log, ==, "");
+	g_free(log);
+
+	log = parse(buf, 0);
+	g_assert_cmpstr(log, ==, "");
+	g_free(log);
+
+	g_byte_array_unref(buf);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/monitor-event/device-name", test_device_name);
+	g_test_add_func("/monitor-event/parse", test_parse);
+
+	return g_test_run();
+}